@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sys/stat.h>
+#include "MissionGenerator.h"
+#include "solver.h"
+#include "utils.h"
+
+using namespace std;
+
+namespace {
+    template<typename F>
+    double bestOf(int nReps, F f) {
+        double best = 1e18;
+        for (int r = 0; r < nReps; r++) {
+            auto start = chrono::steady_clock::now();
+            f();
+            best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+/**
+ * Generates a synthetic mission and times the mission, obstacle and trajectory loaders
+ * and the planning of every horizon.
+ * usage: swarmsim_io_benchmark [drones] [horizons] [subgoals] [obstacles] [repetitions] [plan]
+ * plan = 0 skips the planning.
+ */
+int main(int argc, char **argv) {
+    MissionSpec spec;
+    spec.nDrones = argc > 1 ? atoi(argv[1]) : 100;
+    spec.nHorizons = argc > 2 ? atoi(argv[2]) : 10;
+    spec.nSubgoals = argc > 3 ? atoi(argv[3]) : 5;
+    spec.nObstacles = argc > 4 ? atoi(argv[4]) : 100;
+    int nReps = argc > 5 ? atoi(argv[5]) : 3;
+    bool plan = argc > 6 ? atoi(argv[6]) != 0 : true;
+    string dir = "/tmp/swarmsim_io_benchmark/";
+    mkdir(dir.c_str(), 0755);
+
+    MissionGenerator generator(spec);
+    generator.writeMission(dir + "goals.yaml");
+    generator.writeObstacles(dir + "obstacles.yaml");
+    generator.writeTrajectories(dir);
+    cout << spec.nDrones << " drones, " << spec.nHorizons << " horizons, " << spec.nSubgoals << " subgoals, "
+         << spec.nObstacles << " obstacles" << endl;
+
+    string missionPath = dir + "goals.yaml";
+    YamlDescriptor yamlDescriptor;
+    double ms = bestOf(nReps, [&]() {
+        yamlDescriptor = YamlDescriptor();
+        simutils::processYamlFile(&missionPath[0], yamlDescriptor);
+    });
+    cout << "processYamlFile: " << ms << " ms" << endl;
+
+    ms = bestOf(nReps, [&]() {
+        simutils::readObstacleConfig(dir + "obstacles.yaml");
+    });
+    cout << "readObstacleConfig: " << ms << " ms" << endl;
+
+    ms = bestOf(nReps, [&]() {
+        simutils::loadTrajectoriesFromFile(spec.nDrones, dir);
+    });
+    cout << "loadTrajectoriesFromFile: " << ms << " ms" << endl;
+
+    if (!plan) {
+        return 0;
+    }
+    //planned like the online planner, each horizon continuing from the previous plan
+    vector<TrajectoryPtr> prevPlan;
+    double total = 0;
+    for (int h = 0; h < spec.nHorizons; h++) {
+        vector<Trajectory> wpts = simutils::getHorizonTrajetories(h, yamlDescriptor);
+        Solver solver(spec.nDrones, 4, 4, spec.frequency);
+        auto start = chrono::steady_clock::now();
+        prevPlan = solver.solve(wpts, h == 0, false, prevPlan);
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        total += ms;
+        cout << "planning horizon " << h << ": " << ms << " ms" << endl;
+    }
+    cout << "planning: " << total << " ms, " << total / spec.nHorizons << " ms per horizon" << endl;
+    return 0;
+}
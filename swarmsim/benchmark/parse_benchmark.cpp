@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include "MissionParser.h"
+#include "IndexedMission.h"
+#include "MissionGenerator.h"
+
+using namespace std;
+
+/**
+ * Generates a synthetic mission and measures how long MissionParser takes to load it.
+ * usage: swarmsim_parse_benchmark [drones] [horizons] [subgoals] [repetitions]
+ */
+int main(int argc, char **argv) {
+    int nDrones = argc > 1 ? atoi(argv[1]) : 1000;
+    int nHorizons = argc > 2 ? atoi(argv[2]) : 100;
+    int nSubgoals = argc > 3 ? atoi(argv[3]) : 5;
+    int nReps = argc > 4 ? atoi(argv[4]) : 5;
+    string fPath = "/tmp/swarmsim_parse_benchmark.yaml";
+
+    MissionSpec spec;
+    spec.nDrones = nDrones;
+    spec.nHorizons = nHorizons;
+    spec.nSubgoals = nSubgoals;
+    MissionGenerator(spec).writeMission(fPath);
+
+    ifstream in(fPath.c_str(), ios::binary | ios::ate);
+    double mb = in.tellg() / (1024.0 * 1024.0);
+    double best = 1e18;
+    for (int r = 0; r < nReps; r++) {
+        YamlDescriptor yamlDescriptor;
+        auto start = chrono::steady_clock::now();
+        MissionParser::parseFile(fPath, yamlDescriptor);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        best = min(best, ms);
+        if (yamlDescriptor.getDrones() != nDrones || yamlDescriptor.getHorizons() != nHorizons) {
+            cerr << "Parsed mission does not match the generated one" << endl;
+            return 1;
+        }
+    }
+    cout << nDrones << " drones, " << nHorizons << " horizons, " << mb << " MB: " << best << " ms ("
+         << mb / (best / 1000.0) << " MB/s)" << endl;
+
+    //indexing only, plus materializing the first horizon as the planner does on start
+    double bestIndex = 1e18;
+    double bestHorizon = 1e18;
+    for (int r = 0; r < nReps; r++) {
+        auto start = chrono::steady_clock::now();
+        IndexedMission mission(fPath);
+        auto indexed = chrono::steady_clock::now();
+        mission.getHorizon(0);
+        auto end = chrono::steady_clock::now();
+        bestIndex = min(bestIndex, chrono::duration<double, milli>(indexed - start).count());
+        bestHorizon = min(bestHorizon, chrono::duration<double, milli>(end - indexed).count());
+    }
+    cout << "indexed in " << bestIndex << " ms, first horizon in " << bestHorizon << " ms" << endl;
+    remove(fPath.c_str());
+    return 0;
+}
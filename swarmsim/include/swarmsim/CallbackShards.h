@@ -0,0 +1,93 @@
+#ifndef CALLBACK_SHARDS_H
+#define CALLBACK_SHARDS_H
+
+#include <ros/callback_queue.h>
+#include <ros/spinner.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Callback counters of a queue since the previous report. Latencies are in seconds, from
+ * the arrival of a message in the queue until its callback starts.
+ */
+struct CallbackStats {
+    size_t depth;
+    size_t maxDepth;
+    uint64_t callbacks;
+    double meanLatency;
+    double maxLatency;
+};
+
+/**
+ * Callback queue that keeps track of how many callbacks wait in it and how long they wait.
+ */
+class MonitoredCallbackQueue : public ros::CallbackQueue {
+public:
+    MonitoredCallbackQueue();
+
+    /**
+     * drops the waiting callbacks while the counters they report to still exist
+     */
+    ~MonitoredCallbackQueue() override;
+
+    void addCallback(const ros::CallbackInterfacePtr &callback, uint64_t owner_id = 0) override;
+
+    /**
+     * the current depth and the counters since the previous call
+     */
+    CallbackStats getStats();
+
+private:
+    friend class TimedCallback;
+
+    atomic<size_t> depth;
+    atomic<size_t> maxDepth;
+    atomic<uint64_t> callbacks;
+    atomic<uint64_t> totalLatencyNs;
+    atomic<uint64_t> maxLatencyNs;
+
+    void started(chrono::steady_clock::duration latency);
+
+    void finished();
+};
+
+/**
+ * Spreads the subscriptions of the drones over a few callback queues, each served by its
+ * own spinner thread. A drone always lands on the same shard, so its callbacks still run
+ * in order, while the callbacks of different shards and the control loop on the global
+ * queue run in parallel.
+ */
+class CallbackShards {
+public:
+    explicit CallbackShards(int nShards);
+
+    ~CallbackShards();
+
+    ros::CallbackQueue *getQueue(int droneId);
+
+    /**
+     * starts the spinners once the subscriptions are in place
+     */
+    void start();
+
+    int getShards();
+
+    CallbackStats getStats(int shard);
+
+    /**
+     * one line summary of the queue depths and latencies of the shards, for the logs
+     */
+    string report();
+
+private:
+    vector<unique_ptr<MonitoredCallbackQueue> > queues;
+    vector<unique_ptr<ros::AsyncSpinner> > spinners;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef COMMAND_DISPATCHER_H
+#define COMMAND_DISPATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+enum CommandType {ArmCommand = 0, TakeoffCommand, LandCommand, SetModeCommand, NCommandTypes};
+
+enum CommandStatus {CommandIdle = 0, CommandPending, CommandSucceeded, CommandFailed};
+
+/**
+ * Issues the blocking service calls of the drones (arming, takeoff, landing and mode
+ * switches) from a pool of worker threads, so the control loop only queues them and
+ * polls their status. Commands of different drones run concurrently while the commands
+ * of one drone run one at a time in the order they were dispatched. A call that fails
+ * is retried after retryDelay seconds, up to maxAttempts times.
+ */
+class CommandDispatcher {
+public:
+    CommandDispatcher(int nDrones, int nThreads = 8, int maxAttempts = 3, double retryDelay = 0.5);
+
+    /**
+     * drops the queued commands and joins the workers once the calls in flight return
+     */
+    ~CommandDispatcher();
+
+    CommandDispatcher(const CommandDispatcher &) = delete;
+
+    CommandDispatcher &operator=(const CommandDispatcher &) = delete;
+
+    /**
+     * Queues a call for the drone. call returns true once the command is accepted. Safe to call
+     * from any thread.
+     */
+    void dispatch(int droneId, CommandType type, function<bool()> call);
+
+    /**
+     * Pending while a command of this type is queued or in flight for the drone,
+     * otherwise the outcome of the last one.
+     */
+    CommandStatus getStatus(int droneId, CommandType type);
+
+    /**
+     * forgets the outcome of the last command of this type so the status reads idle again
+     */
+    void reset(int droneId, CommandType type);
+
+    /**
+     * number of commands queued or in flight
+     */
+    int getPending();
+
+    static const char *getName(CommandType type);
+
+private:
+    struct Command {
+        int droneId;
+        CommandType type;
+        function<bool()> call;
+        int attempt;
+        chrono::steady_clock::time_point notBefore;
+    };
+
+    struct Slot {
+        int outstanding;
+        CommandStatus last;
+    };
+
+    int nDrones;
+    int maxAttempts;
+    chrono::steady_clock::duration retryDelay;
+    mutex dispatchMutex;
+    condition_variable wakeup;
+    deque<Command> queue;
+    vector<Slot> slots;
+    vector<char> busy;
+    vector<char> scanned;
+    int inFlight;
+    bool stopped;
+    vector<thread> workers;
+
+    void workLoop();
+
+    /**
+     * Takes the first command whose drone is idle and whose retry delay has passed. Earlier
+     * commands of a drone block its later ones. Sets wakeAt to the earliest retry time if none is ready.
+     */
+    bool takeNext(Command &command, chrono::steady_clock::time_point &wakeAt);
+
+    Slot &getSlot(int droneId, CommandType type) { return slots[droneId * NCommandTypes + type]; }
+};
+
+#endif
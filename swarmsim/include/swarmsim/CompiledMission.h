@@ -0,0 +1,111 @@
+#ifndef COMPILED_MISSION_H
+#define COMPILED_MISSION_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Trajectory.h"
+#include "Obstacle.h"
+
+using namespace std;
+
+/**
+ * Layout of a compiled mission, in native byte order. Offsets are in bytes from the start
+ * of the file and every block starts on a 64 byte boundary:
+ *   CompiledMissionHeader
+ *   CompiledTrajectoryEntry[nDrones * nHorizons], drone k horizon h at k * nHorizons + h
+ *   CompiledObstacle[nObstacles]
+ *   per entry nine series of nSamples doubles: pos x, y, z, vel x, y, z, acc x, y, z
+ * checksum is FNV-1a over everything after the header.
+ */
+struct CompiledMissionHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nDrones;
+    uint32_t nHorizons;
+    uint32_t nObstacles;
+    double frequency;
+    uint64_t entriesOffset;
+    uint64_t obstaclesOffset;
+    uint64_t fileSize;
+    uint64_t checksum;
+};
+
+struct CompiledTrajectoryEntry {
+    uint64_t offset;
+    //bytes from one series to the next
+    uint64_t stride;
+    uint32_t nSamples;
+    uint32_t reserved;
+};
+
+struct CompiledObstacle {
+    double center[3];
+    double height;
+    double width;
+    double length;
+};
+
+enum CompiledSeries {PosX = 0, PosY, PosZ, VelX, VelY, VelZ, AccX, AccY, AccZ, NumSeries};
+
+/**
+ * Read only view of a mission solved offline by the mission compiler. The file is memory
+ * mapped, so opening it costs no parsing and the pages are shared by every process flying it.
+ */
+class CompiledMission {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Maps the file and validates its layout. verify also checks the checksum, which reads
+     * the whole file. Throws runtime_error if the file is not a valid compiled mission.
+     */
+    explicit CompiledMission(const string &fPath, bool verify = true);
+
+    int getDrones() const;
+
+    int getHorizons() const;
+
+    /**
+     * sampling frequency (Hz) the trajectories were solved for
+     */
+    double getFrequency() const;
+
+    int getSamples(int droneId, int horizonId) const;
+
+    /**
+     * nSamples values of one series, pointing into the mapping
+     */
+    const double *getSeries(int droneId, int horizonId, int series) const;
+
+    Trajectory getTrajectory(int droneId, int horizonId) const;
+
+    /**
+     * The trajectory of a drone in a horizon without copying it: its series point into the
+     * mapping, which the returned pointer keeps alive along with mission.
+     */
+    static TrajectoryPtr getTrajectoryView(const shared_ptr<const CompiledMission> &mission, int droneId,
+                                           int horizonId);
+
+    vector<Obstacle> getObstacles() const;
+
+    /**
+     * Writes plans[h][k], the trajectory of drone k in horizon h. The file is written
+     * next to fPath and renamed over it, so readers never see a partial mission.
+     */
+    static void write(const string &fPath, double frequency, const vector<vector<TrajectoryPtr> > &plans,
+                      const vector<Obstacle> &obstacles);
+
+    static uint64_t checksum(const char *begin, const char *end);
+
+private:
+    MappedFile file;
+    const CompiledMissionHeader *header;
+    const CompiledTrajectoryEntry *entries;
+
+    const CompiledTrajectoryEntry &getEntry(int droneId, int horizonId) const;
+};
+
+#endif
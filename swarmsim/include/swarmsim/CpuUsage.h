@@ -0,0 +1,53 @@
+#ifndef CPU_USAGE_H
+#define CPU_USAGE_H
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * CPU time, user and system, per second of wall time of this process and of the other
+ * processes named in the constructor, read from /proc. A nodelet manager accounts for every
+ * nodelet it hosts; with nodes, the segment executors have to be named to be counted.
+ */
+class CpuUsage {
+public:
+    /**
+     * processes: executable names of the other processes to count along with this one,
+     * e.g. segment_executor
+     */
+    explicit CpuUsage(vector<string> processes = vector<string>());
+
+    /**
+     * share of one core used since the previous call (or the construction), 1 being a full core
+     */
+    double sample();
+
+    /**
+     * number of processes counted by the last sample
+     */
+    int getProcesses() const;
+
+private:
+    vector<string> processes;
+    //CPU seconds of every counted process, by pid
+    map<int, double> lastCpu;
+    chrono::steady_clock::time_point lastWall;
+
+    map<int, double> readCpu() const;
+
+    /**
+     * CPU seconds of pid, negative if it is gone
+     */
+    static double processCpu(int pid);
+
+    /**
+     * executable name of pid, without its directory
+     */
+    static string processName(int pid);
+};
+
+#endif
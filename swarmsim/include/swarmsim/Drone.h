@@ -1,4 +1,5 @@
 #include <iostream>
+#include <deque>
 #include <eigen3/Eigen/Dense>
 #include "ros/ros.h"
 #include "tf/tf.h"
@@ -8,29 +9,112 @@
 #include "state.h"
 #include "Trajectory.h"
 #include "mavros_msgs/State.h"
+#include "mavros_msgs/PositionTarget.h"
 #include "gazebo_msgs/ModelStates.h"
+#include "FlightRecorder.h"
+#include "MissionCheckpoint.h"
+#include "TrajectoryQueue.h"
+#include "SetpointTick.h"
+#include "CommandDispatcher.h"
+#include "SeqlockSlot.h"
+#include "SegmentedTrajectory.h"
+#include "StateCounters.h"
+#include "TrackingStats.h"
+#include <ros/callback_queue.h>
+#include <atomic>
+#include <mutex>
 
 using namespace Eigen;
 
 class Drone {
 public:
-  Drone(int id, const ros::NodeHandle &n);
+    /**
+     * dispatcher: issues the service calls of the drone, so none of them blocks the caller
+     * callbacks: queue serving the drone's subscriptions, nullptr for the global queue
+     * counters: where the drone reports its state transitions, nullptr if nobody counts them
+     */
+    Drone(int id, const ros::NodeHandle &n, CommandDispatcher *dispatcher, ros::CallbackQueue *callbacks = nullptr,
+          StateCounters *counters = nullptr);
+
+    /**
+     * Takes over the latest position samples of the subscription callbacks, which may run
+     * on another thread. Called by the control loop at the start of every tick.
+     */
+    void updatePose();
 
     /**
-     * function for arming or disarming a drone. Uses the service:
+     * function for arming a drone. Uses the service:
      * /<drone_id>/mavros/cmd/arming
+     * The request is dispatched asynchronously; call it every tick until the drone
+     * reports States::Armed. Failed requests are sent again.
      */
     void arm(bool arm);
 
     /**
      * function for taking off a drone. Uses the service:
      * /<drone_id>/mavros/cmd/takeoff
+     * Keep calling it with takeoff set while the drone is autonomous, a rejected switch to
+     * OFFBOARD is requested again.
      */
     void TOLService(bool takeoff);
     int getState();
-    void setTrajectory(Trajectory trajectory);
-    int executeTrajectory();
-    void pushTrajectory(Trajectory trajectory);
+
+    /**
+     * Publishes the setpoint of the trajectory at time now (s) of the swarm clock, interpolated
+     * between the samples, which are taken sampleRate times a second. The first call starts
+     * the timeline; a late or skipped tick does not shift it. Runs on the setpoint thread,
+     * every method touching the trajectories shares trajectoryMutex with it.
+     * Returns the index of the sample at or before now.
+     */
+    int executeTrajectory(double now, double sampleRate);
+
+    /**
+     * Publishes the velocity and acceleration of the trajectory along with the position as a
+     * mavros_msgs::PositionTarget on /<drone_id>/mavros/setpoint_raw/local, so the autopilot
+     * does not have to infer the motion from the position error. Position only by default.
+     */
+    void setFeedforward(bool feedforward);
+
+    /**
+     * Sends every horizon once as polynomial segments on /<drone_id>/swarm/segments, within
+     * tolerance (m) of the samples, and leaves the setpoints to the SegmentExecutor of the drone.
+     * executeTrajectory then only keeps track of the progress; now has to be ROS time, the
+     * clock the executor shares with the swarm.
+     */
+    void setSegmentExecution(bool segments, double tolerance);
+
+    /**
+     * tracking error accumulated since the start of the mission
+     */
+    TrackingStats getTrackingStats();
+    void pushTrajectory(TrajectoryPtr trajectory);
+
+    /**
+     * Finds the sample of the current trajectory ticksAhead control ticks from now.
+     * Returns false if the current trajectory ends before that. trajectoryId is the
+     * trajectory the splice point belongs to.
+     */
+    bool getSplicePoint(int ticksAhead, int &spliceIdx, TrajectoryState &state, int &trajectoryId);
+
+    /**
+     * state at the end of the current trajectory
+     */
+    TrajectoryState getEndState();
+
+    /**
+     * Where the drone is expected to be once it has flown all its queued trajectories: the end
+     * of the last one, offset by the current tracking error.
+     */
+    Vector3d getExpectedEndPosition();
+    int getTrajectorySize();
+
+    /**
+     * Replaces the current trajectory from spliceIdx onwards with splice, whose first
+     * sample must be the state at spliceIdx. Rejected if the drone has moved on to another
+     * trajectory or already passed spliceIdx.
+     */
+    bool spliceTrajectory(const Trajectory &splice, int trajectoryId, int spliceIdx);
+    int getTrajectoryId();
     /**
      * Perform the conversion between the droneLocal frame and the gazebo frame.
      * MavRos expects the waypoints in the drone local frame, whereas the yaml specifies 
@@ -39,6 +123,33 @@ public:
     Vector3d getLocalWaypoint(Vector3d waypoint);
     void publishGlobalPose();
 
+    /**
+     * Pose of the drone's model in gazebo, dispatched by the swarm from its model_states
+     * subscription. The first pose received once the drone is armed becomes its home.
+     */
+    void setGazeboPose(const geometry_msgs::Pose &pose);
+
+    /**
+     * true once the home position in the gazebo frame is known
+     */
+    bool hasHome();
+
+    /**
+     * records the setpoints and the local poses of the drone. nullptr disables recording
+     */
+    void setRecorder(FlightRecorder *recorder);
+
+    /**
+     * progress of the drone, shares the trajectories instead of copying them
+     */
+    DroneCheckpoint getCheckpoint();
+
+    /**
+     * Continues a mission from a checkpoint. The home position is taken from the checkpoint
+     * as the drone may already be in the air, and no takeoff is requested if it is.
+     */
+    void restore(const DroneCheckpoint &checkpoint);
+
 private:
     int id;
     Vector3d curr_pos_local;
@@ -46,38 +157,77 @@ private:
     Vector3d init_pos_global;
     Vector3d init_pos_local;
     float yaw;
-    int state;
+    std::atomic<int> state;
+    StateCounters *counters;
     float takeoffHeight;
-    Trajectory trajectory;
-    int execPointer;
     bool setReady;
     Vector3d initGazeboPos;
-    int gazeboElementIdx;
+    bool homeRecorded;
     geometry_msgs::PoseStamped pose_global;
 
-    std::vector<Trajectory> TrajectoryList;
-    int trajectoryId;
+    struct LocalPoseSample {
+        double position[3];
+        double orientation[4];
+    };
+
+    struct GlobalFixSample {
+        double position[3];
+    };
+
+    //written by the position callbacks, read by updatePose()
+    SeqlockSlot<LocalPoseSample> localPoseSlot;
+    SeqlockSlot<GlobalFixSample> globalFixSlot;
+
+    //the trajectory being executed followed by the ones pushed for the next horizons
+    TrajectoryQueue queue;
+    //guards queue and tracking
+    std::mutex trajectoryMutex;
+    TrackingStats tracking;
+    //samples the queue and fills the setpoint messages, reused by every tick
+    SetpointTick tick;
+    double segmentTolerance;
+    //last horizon sent to the executor, -1 if none
+    int sentTrajectoryId;
+    FlightRecorder *recorder;
+    bool resumed;
 
     ros::NodeHandle nh;
     ros::Subscriber localPositionSub;
     ros::Subscriber globalPositionSub;
     ros::Subscriber poseSub;
     ros::Publisher posSetPointPub;
+    ros::Publisher rawSetPointPub;
+    ros::Publisher segmentsPub;
     ros::Subscriber mavrosStateSub;
-    ros::Subscriber gazeboStateSub;
     ros::Publisher globalPosePub;
+    //persistent, created once and replaced by the dispatcher workers when their connection drops
+    ros::ServiceClient armingClient;
+    ros::ServiceClient takeoffClient;
+    ros::ServiceClient landClient;
+    ros::ServiceClient setModeClient;
+    //last mode passed to setMode, requested again if the switch fails. setMode runs on the setpoint
+    //thread as well, modeMutex guards the mode along with the status checks of its requests
+    std::string requestedMode;
+    std::mutex modeMutex;
+    CommandDispatcher *dispatcher;
 
     void mavrosStateCB(const mavros_msgs::StateConstPtr& msg);
     void setMode(std::string mode);
+    //requests requestedMode, callers hold modeMutex
+    void dispatchMode();
     void positionGlobalCB(const sensor_msgs::NavSatFixConstPtr& msg);
     void positionLocalCB(const nav_msgs::OdometryConstPtr& msg);
     // void poseCB(const geometry_msgs::PoseStampedConstPtr& msg);
     void setState(int state);
     void ready(bool ready);
     bool reachedGoal(geometry_msgs::PoseStamped setPoint);
-    void sendPositionSetPoint(geometry_msgs::PoseStamped setPoint);
+    void sendPositionSetPoint(const geometry_msgs::PoseStamped &setPoint);
+    void sendPositionTarget(const mavros_msgs::PositionTarget &target);
+    //callers hold trajectoryMutex
+    void updateTracking(const Vector3d &waypoint);
+    //sends the horizons the executor has not received yet, callers hold trajectoryMutex
+    void sendSegments(double sampleRate);
     void callTOLService(bool takeoff);
-    void gazeboStateCB(const gazebo_msgs::ModelStatesConstPtr& msg);
 
 // todo: move to a util class
     /**
@@ -0,0 +1,92 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <eigen3/Eigen/Dense>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LockFreeQueue.h"
+
+using namespace std;
+
+enum RecordType {SwarmStateRecord = 0, SetpointRecord, PoseRecord, PlanningRecord};
+
+enum PlanningEvent {PlanningStarted = 0, PlanningCommitted, PlanningFailed, SpliceStarted, SpliceAdopted};
+
+/**
+ * One entry of the flight log. Records have a fixed size so they can be passed through
+ * the ring buffer and written to the log without serialization.
+ * droneId is -1 for swarm records. value holds the swarm state, the execPointer of a
+ * setpoint or the horizon of a planning event.
+ */
+struct FlightRecord {
+    double stamp;
+    double x;
+    double y;
+    double z;
+    int32_t droneId;
+    int32_t value;
+    uint8_t type;
+    uint8_t event;
+    uint8_t reserved[6];
+};
+
+struct FlightLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+/**
+ * Records the flight into a binary log. The record calls only copy the record into a
+ * lock free ring buffer and can be made from any thread; a background thread writes the
+ * buffer to the log. Records are dropped rather than blocking the caller when the
+ * writer falls behind.
+ */
+class FlightRecorder {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Opens the log for writing. Throws runtime_error if it cannot be created.
+     * capacity: number of records buffered before records are dropped
+     */
+    explicit FlightRecorder(const string &fPath, size_t capacity = 1 << 16);
+
+    /**
+     * writes the remaining records and closes the log
+     */
+    ~FlightRecorder();
+
+    void recordState(double stamp, int state);
+
+    void recordSetpoint(double stamp, int droneId, const Eigen::Vector3d &pos, int execPointer);
+
+    void recordPose(double stamp, int droneId, const Eigen::Vector3d &pos);
+
+    void recordPlanningEvent(double stamp, PlanningEvent event, int horizonId);
+
+    void record(const FlightRecord &r);
+
+    uint64_t getDropped() const;
+
+    /**
+     * Reads a whole log back for offline analysis. Throws runtime_error if the file
+     * is not a flight log.
+     */
+    static vector<FlightRecord> readLog(const string &fPath);
+
+private:
+    LockFreeQueue<FlightRecord> queue;
+    ofstream out;
+    thread writer;
+    atomic<bool> stopped;
+    atomic<uint64_t> dropped;
+
+    void writeLoop();
+};
+
+#endif
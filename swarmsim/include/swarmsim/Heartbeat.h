@@ -0,0 +1,31 @@
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+#include <limits>
+
+/**
+ * Decides when a message has to be sent again because nothing was sent for period seconds.
+ * Every send counts, whatever triggered it, and all times come from the clock of the caller,
+ * which has to be the same for due and sent.
+ */
+class Heartbeat {
+public:
+    /**
+     * period 0 disables the heartbeat
+     */
+    explicit Heartbeat(double period = 0) : period(period), last(-std::numeric_limits<double>::infinity()) {}
+
+    bool due(double now) const {
+        return period > 0 && now - last >= period;
+    }
+
+    void sent(double now) {
+        last = now;
+    }
+
+private:
+    double period;
+    double last;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef INDEXED_MISSION_H
+#define INDEXED_MISSION_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include "MappedFile.h"
+#include "Trajectory.h"
+#include "HorizonTimes.h"
+
+using namespace std;
+
+/**
+ * Mission reader for large missions. The file is memory mapped and scanned once to
+ * record where each drone's horizon starts and to validate every subgoal. Subgoals are
+ * only stored for the horizon being planned and the next window horizons, so memory
+ * stays bounded by the window instead of growing with the mission length.
+ */
+class IndexedMission {
+public:
+    /**
+     * Maps and indexes the mission file. Throws runtime_error if the file cannot be
+     * read or its structure or any subgoal is malformed, so a mission that loads does
+     * not fail mid flight.
+     */
+    explicit IndexedMission(const string &fPath, int window = 0);
+
+    /**
+     * Returns the subgoals and segment times of every drone for the horizon. Throws
+     * range_error past the last horizon and runtime_error if a subgoal is malformed.
+     */
+    vector<Trajectory> getHorizon(int horizonId);
+
+    int getDrones() const;
+
+    int getHorizons() const;
+
+    int getSubGoals() const;
+
+    double getMovingThreshold() const;
+
+    double getHoveringThreshold() const;
+
+    const vector<HorizonTimes> &getTimesArray() const;
+
+    /**
+     * number of horizons currently held in memory
+     */
+    int getCachedHorizons();
+
+private:
+    MappedFile file;
+    int window;
+    int nDrones;
+    int nHorizons;
+    int nSubgoals;
+    double movingThreshold;
+    double hoveringThreshold;
+    vector<HorizonTimes> timesArray;
+
+    //offsets[k * nHorizons + h] is the first byte after the horizonN: line of drone k
+    vector<size_t> offsets;
+    map<int, vector<Trajectory> > cache;
+    mutex cacheMutex;
+
+    void buildIndex();
+
+    vector<Trajectory> readHorizon(int horizonId);
+
+    void readSubgoals(const char *cur, int lineNo, Trajectory &tr);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded multi-producer multi-consumer queue. Every slot carries a sequence number
+ * that tells producers and consumers whether it is free for them, so push and pop
+ * never take a lock. The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class LockFreeQueue {
+public:
+    explicit LockFreeQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        buffer.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    LockFreeQueue(const LockFreeQueue &) = delete;
+
+    LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+    /**
+     * returns false if the queue is full
+     */
+    bool push(T item) {
+        Cell *cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * returns false if the queue is empty
+     */
+    bool pop(T &item) {
+        Cell *cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &buffer[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> buffer;
+    size_t mask;
+    //keep the producer and consumer cursors on separate cache lines
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+};
+
+#endif
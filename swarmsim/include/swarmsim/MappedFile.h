@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Read only memory mapping of a whole file. The mapping is released with the object.
+ * Pages are loaded on first access, so opening a large file costs no reads up front.
+ */
+class MappedFile {
+public:
+    MappedFile();
+
+    /**
+     * maps fPath. Throws runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const string &fPath);
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile();
+
+    const char *begin() const;
+
+    const char *end() const;
+
+    size_t size() const;
+
+private:
+    const char *data;
+    size_t length;
+
+    void release();
+};
+
+#endif
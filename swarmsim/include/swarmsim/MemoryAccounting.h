@@ -0,0 +1,44 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+enum MemorySubsystem {
+    TrajectoryMemory,
+    VisualizationMemory,
+    RecorderMemory,
+    RegistryMemory,
+    NMemorySubsystems
+};
+
+/**
+ * Process wide counters of the bytes held by the long lived buffers of each subsystem.
+ * The owners report every allocation and release, so the counters can be polled from
+ * any thread to check that a long mission keeps a flat footprint.
+ */
+class MemoryAccounting {
+public:
+    static void allocated(MemorySubsystem subsystem, size_t bytes) { counters[subsystem] += bytes; }
+
+    static void released(MemorySubsystem subsystem, size_t bytes) { counters[subsystem] -= bytes; }
+
+    static size_t getLiveBytes(MemorySubsystem subsystem) { return counters[subsystem]; }
+
+    static size_t getTotalBytes();
+
+    static const char *getName(MemorySubsystem subsystem);
+
+    /**
+     * one line summary of the live bytes per subsystem, for the logs
+     */
+    static string report();
+
+private:
+    static atomic<size_t> counters[NMemorySubsystems];
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef MISSION_CHECKPOINT_H
+#define MISSION_CHECKPOINT_H
+
+#include <eigen3/Eigen/Dense>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Trajectory.h"
+
+using namespace std;
+
+/**
+ * Progress of one drone. trajectories holds the trajectory being executed followed by
+ * the ones queued behind it; the executed ones are not kept.
+ * home is the gazebo position the drone armed at, which anchors its local frame.
+ */
+struct DroneCheckpoint {
+    Eigen::Vector3d home;
+    int trajectoryId;
+    int execPointer;
+    vector<TrajectoryPtr> trajectories;
+};
+
+/**
+ * State needed to resume a planned mission. horizonId is the next horizon to plan.
+ * The last queued trajectory of every drone is the previous plan the next horizon
+ * is chained on.
+ */
+struct SwarmCheckpoint {
+    string mission;
+    int horizonId;
+    int nHorizons;
+    vector<DroneCheckpoint> drones;
+};
+
+/**
+ * Layout of a checkpoint, in native byte order:
+ *   MissionCheckpointHeader
+ *   mission path, missionLength bytes
+ *   per drone: home (3 doubles), trajectoryId, execPointer, number of trajectories (int32 each)
+ *   per trajectory: sample counts of pos, vel, acc and tList (uint32 each) followed by the values
+ * checksum is FNV-1a over everything after the header.
+ */
+struct MissionCheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nDrones;
+    int32_t horizonId;
+    int32_t nHorizons;
+    uint32_t missionLength;
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint64_t checksum;
+};
+
+/**
+ * Saves and restores the progress of a running mission, so a restarted node picks up
+ * the mission where it stopped instead of planning it again from the first horizon.
+ */
+class MissionCheckpoint {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Writes the checkpoint next to fPath and renames it over fPath, so a crash while
+     * writing leaves the previous checkpoint in place. Throws runtime_error on failure.
+     */
+    static void write(const string &fPath, const SwarmCheckpoint &checkpoint);
+
+    /**
+     * Throws runtime_error if the file is missing, truncated or fails the checksum.
+     */
+    static SwarmCheckpoint read(const string &fPath);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef MISSION_GENERATOR_H
+#define MISSION_GENERATOR_H
+
+#include <eigen3/Eigen/Dense>
+#include <string>
+#include <vector>
+#include "Obstacle.h"
+
+using namespace std;
+
+/**
+ * size of a synthetic mission. segmentTime is the time (s) between two subgoals and
+ * frequency the sampling rate (Hz) of the generated position files.
+ */
+struct MissionSpec {
+    int nDrones = 5;
+    int nHorizons = 6;
+    int nSubgoals = 5;
+    int nObstacles = 5;
+    double segmentTime = 3;
+    double frequency = 100;
+    unsigned int seed = 1;
+};
+
+/**
+ * Generates missions in the formats of goals.yaml, obstacles.yaml and pos_<i>.txt for
+ * stress testing the loaders and the planner. Drones start side by side and random walk
+ * from subgoal to subgoal; each horizon starts at the last subgoal of the previous one.
+ * The same seed gives the same mission with the same standard library.
+ */
+class MissionGenerator {
+public:
+    explicit MissionGenerator(const MissionSpec &spec);
+
+    /**
+     * writes the mission yaml. Throws runtime_error if the file cannot be written.
+     */
+    void writeMission(const string &fPath);
+
+    void writeObstacles(const string &fPath);
+
+    /**
+     * writes dir/pos_<i>.txt, the subgoals of drone i linearly interpolated at the spec frequency
+     */
+    void writeTrajectories(const string &dir);
+
+    const vector<Eigen::Vector3d> &getSubgoals(int droneId);
+
+private:
+    MissionSpec spec;
+    //subgoal j of horizon h of drone k is subgoals[k][h * (nSubgoals - 1) + j]
+    vector<vector<Eigen::Vector3d> > subgoals;
+    vector<Obstacle> obstacles;
+};
+
+#endif
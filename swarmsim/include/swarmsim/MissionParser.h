@@ -0,0 +1,72 @@
+#ifndef MISSION_PARSER_H
+#define MISSION_PARSER_H
+
+#include <string>
+#include <vector>
+#include "YamlDescriptor.h"
+
+using namespace std;
+
+/**
+ * Single pass parser for the mission yaml files. The missions only use a small
+ * subset of yaml (one "key: value" per line, flow sequences of numbers and # comments),
+ * so the keys are tokenized directly instead of going through libyaml events and regexes.
+ * droneN, horizonN and timesetN accept any non-negative index.
+ */
+class MissionParser {
+public:
+    /**
+     * one "key: value" line. Ranges point into the parsed buffer and exclude
+     * the surrounding whitespace and comments. An absent value is an empty range.
+     */
+    struct Line {
+        const char *keyBegin;
+        const char *keyEnd;
+        const char *valueBegin;
+        const char *valueEnd;
+        const char *lineBegin;
+        int lineNo;
+    };
+
+    /**
+     * Parses the mission file into yamlDescriptor. Throws runtime_error if the file
+     * cannot be read or is malformed.
+     */
+    static void parseFile(const string &fPath, YamlDescriptor &yamlDescriptor);
+
+    static void parse(const char *begin, const char *end, YamlDescriptor &yamlDescriptor);
+
+    /**
+     * reads the whole file into a string with a single open
+     */
+    static string readFile(const string &fPath);
+
+    /**
+     * Advances cur to the next non-empty line and tokenizes it. Returns false at the end
+     * of the buffer. A flow sequence may continue over several lines.
+     */
+    static bool nextLine(const char *&cur, const char *end, int &lineNo, Line &line);
+
+    static bool keyEquals(const Line &line, const char *key);
+
+    /**
+     * true if the key is prefix followed by a decimal index, eg: drone12
+     */
+    static bool parseIndexedKey(const Line &line, const char *prefix, int &idx);
+
+    /**
+     * parses a scalar or a flow sequence of numbers into out
+     */
+    static void parseNumbers(const Line &line, vector<double> &out);
+
+    static double parseNumber(const Line &line);
+
+    /**
+     * parses the whole range [p, e) as a double. Returns false if it is not a number.
+     */
+    static bool parseDouble(const char *p, const char *e, double &val);
+
+    static void fail(const Line &line, const string &msg);
+};
+
+#endif
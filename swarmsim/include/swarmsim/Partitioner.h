@@ -0,0 +1,64 @@
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include <eigen3/Eigen/Dense>
+#include <vector>
+#include <utility>
+#include "Trajectory.h"
+
+using namespace std;
+
+/**
+ * Result of partitioning the swarm for one horizon. Every drone belongs to exactly
+ * one cluster. boundaryPairs lists the drones of different clusters whose regions
+ * overlap, which are the only pairs that have to be reconciled across clusters.
+ */
+struct Partition {
+    vector<vector<int> > clusters;
+    vector<int> clusterOf;
+    vector<pair<int, int> > boundaryPairs;
+    vector<Eigen::AlignedBox3d> regions;
+};
+
+/**
+ * Clusters the drones on a uniform grid by the spatial extent of their horizon
+ * waypoints, so that inter-drone checks scale with the cluster size instead of
+ * the swarm size.
+ */
+class Partitioner {
+public:
+    /**
+     * cellSize: edge length (m) of the grid cells drones are clustered into
+     * minSeparation: minimum distance (m) two drones must keep. Regions are inflated by it.
+     */
+    Partitioner(double cellSize, double minSeparation);
+
+    Partition partition(const vector<Trajectory> &droneWpts);
+
+    /**
+     * returns the pairs of drones in the cluster that come closer than minSeparation
+     */
+    vector<pair<int, int> > findConflicts(const vector<int> &cluster, const Partition &partition,
+                                          const vector<TrajectoryPtr> &trajs);
+
+    /**
+     * returns the candidate pairs that come closer than minSeparation
+     */
+    vector<pair<int, int> > findConflicts(const vector<pair<int, int> > &candidates,
+                                          const vector<TrajectoryPtr> &trajs);
+
+    /**
+     * minimum distance between two trajectories sampled on the same time grid
+     */
+    static double minDistance(const Trajectory &a, const Trajectory &b);
+
+private:
+    double cellSize;
+    double minSeparation;
+
+    Eigen::Vector3i getCell(const Eigen::Vector3d &p);
+
+    static long long getCellKey(const Eigen::Vector3i &cell);
+};
+
+#endif
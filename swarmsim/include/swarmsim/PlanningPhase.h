@@ -1,13 +1,28 @@
 #include <iostream>
 #include <future>
 #include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
 #include "Trajectory.h"
 #include "solver.h"
 #include "DiscretePlanner.h"
+#include "LockFreeQueue.h"
+#include "WaypointUpdate.h"
 #include <thread>
 
 using namespace std;
 
+/**
+ * A plan computed ahead of time for a future horizon. seed holds the end positions
+ * of the plan it was chained on, so it can be validated against where the drones are
+ * expected to be once they finish the previous horizon.
+ */
+struct SpeculativePlan {
+    vector<Eigen::Vector3d> seed;
+    vector<TrajectoryPtr> plan;
+};
+
 class PlanningPhase {
 public:
     //set ndrones, map etc in corresponding derived classes.
@@ -17,6 +32,8 @@ public:
 
     PlanningPhase(int nDrones, double frequency);
 
+    virtual ~PlanningPhase();
+
     bool doneInitPlanning;
     DiscretePlanner *discretePlanner;
     int nDrones;
@@ -27,16 +44,98 @@ public:
     vector<Trajectory> discreteWpts;
     thread *planning_t;
 
-    vector<Trajectory> computeSmoothTrajectories(bool initialQP, bool lastQP, std::vector<Trajectory> prevPlan);
+    /**
+     * number of horizons planned ahead of the committed one (0 disables speculation)
+     * and the maximum drift (m) of the expected start positions, tracking error included,
+     * tolerated before a speculative plan is discarded.
+     */
+    int lookahead;
+    double speculationThreshold;
+
+    /**
+     * grid cell size (m) used to cluster the drones for planning and the minimum
+     * separation (m) checked between the planned trajectories
+     */
+    double partitionCellSize;
+    double minSeparation;
+
+    vector<TrajectoryPtr> computeSmoothTrajectories(bool initialQP, bool lastQP, const std::vector<TrajectoryPtr> &prevPlan);
 
-    future<vector<Trajectory> > fut;
+    vector<TrajectoryPtr> computeSmoothTrajectories(const vector<Trajectory> &wpts, bool initialQP, bool lastQP,
+                                                    const std::vector<TrajectoryPtr> &prevPlan);
 
-    // override in derived classes
-    virtual void doPlanning(int horizonId, std::vector<Trajectory> prevPlan);
+    future<vector<TrajectoryPtr> > fut;
+
+    /**
+     * Plans horizonId on a thread of its own, continuing from prevPlan. expectedStart is where
+     * the drones are expected to start the horizon, following their executed trajectories;
+     * a speculative plan is only used if it was chained on positions close to it.
+     * Returns at once, the results are handed over by getPlanningResults().
+     * Override in derived classes.
+     */
+    virtual void doPlanning(int horizonId, std::vector<TrajectoryPtr> prevPlan,
+                            vector<Eigen::Vector3d> expectedStart);
 
     virtual vector<Trajectory> getDiscretePlan(int horizonId);
 
     // virtual void computeFormations();
     // virtual void assignGoals();
-    virtual vector<Trajectory> getPlanningResults();
-};
\ No newline at end of file
+    /**
+     * blocks until the plan of the last doPlanning is ready. Empty if the planning failed
+     */
+    virtual vector<TrajectoryPtr> getPlanningResults();
+
+    /**
+     * queues new subgoals for a drone. Safe to call from any thread. The update is
+     * consumed by the next planning job. Returns false if the queue is full.
+     */
+    bool pushWaypoints(WaypointUpdate update);
+
+    /**
+     * joins the planning thread and drops the speculative plans once no more horizons will be planned
+     */
+    void shutdown();
+
+protected:
+    LockFreeQueue<WaypointUpdate> waypointQueue{256};
+    map<int, SpeculativePlan> speculativePlans;
+    mutex speculationMutex;
+    //bumped by every doPlanning and stopSpeculation, a planning thread of an older round stops speculating
+    atomic<int> planningRound;
+
+    /**
+     * Plans horizons fromHorizon..fromHorizon+lookahead-1, each one chained on the
+     * predicted end state of the one before it. Runs on the planning thread of round after the
+     * committed plan has been handed over and returns between two horizons once a newer round starts.
+     */
+    void speculate(int fromHorizon, vector<TrajectoryPtr> seedPlan, int round);
+
+    /**
+     * Moves the speculative plan for horizonId into plan if its seed is within
+     * speculationThreshold of expectedStart. Stale plans are dropped.
+     */
+    bool takeSpeculativePlan(int horizonId, const vector<Eigen::Vector3d> &expectedStart, vector<TrajectoryPtr> &plan);
+
+    /**
+     * drains the waypoint queue into the discrete plan of the horizon being planned.
+     * Returns true if any drone's subgoals were replaced.
+     */
+    bool applyWaypointUpdates(vector<Trajectory> &wpts);
+
+    /**
+     * drops every speculative plan from horizonId onwards
+     */
+    void invalidateSpeculativePlans(int horizonId);
+
+    /**
+     * signals the running planning thread to stop speculating and joins it, along with the
+     * threads of the earlier rounds it joins itself
+     */
+    void stopSpeculation();
+
+    bool isInitialHorizon(int horizonId);
+
+    bool isLastHorizon(int horizonId);
+
+    static vector<Eigen::Vector3d> getEndPositions(const vector<TrajectoryPtr> &plan);
+};
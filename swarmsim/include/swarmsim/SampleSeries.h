@@ -0,0 +1,130 @@
+#ifndef SAMPLE_SERIES_H
+#define SAMPLE_SERIES_H
+
+#include <eigen3/Eigen/Dense>
+#include <cstddef>
+#include <iterator>
+
+/**
+ * Three dimensional samples stored as a structure of arrays: the x, y and z components are
+ * each a contiguous, 64 byte aligned series of capacity() doubles. A sample is accessed
+ * through an Eigen map striding over the three series, so s[i] reads and writes like an
+ * Eigen::Vector3d while scans over one component stay sequential.
+ * The storage is owned, or borrowed from a TrajectoryArena through attach(). Borrowed
+ * storage is only valid while its arena lives; copies always own their storage.
+ */
+class SampleSeries {
+public:
+    typedef Eigen::Map<Eigen::Vector3d, Eigen::Unaligned, Eigen::InnerStride<> > Ref;
+    typedef Eigen::Map<const Eigen::Vector3d, Eigen::Unaligned, Eigen::InnerStride<> > ConstRef;
+
+    class const_iterator : public std::iterator<std::random_access_iterator_tag, Eigen::Vector3d, std::ptrdiff_t,
+            void, ConstRef> {
+    public:
+        const_iterator(const SampleSeries *series, size_t i) : series(series), i(i) {}
+
+        ConstRef operator*() const { return (*series)[i]; }
+
+        const_iterator &operator++() { i++; return *this; }
+
+        const_iterator operator+(std::ptrdiff_t d) const { return const_iterator(series, i + d); }
+
+        std::ptrdiff_t operator-(const const_iterator &other) const { return (std::ptrdiff_t) i - other.i; }
+
+        bool operator==(const const_iterator &other) const { return i == other.i; }
+
+        bool operator!=(const const_iterator &other) const { return i != other.i; }
+
+    private:
+        const SampleSeries *series;
+        size_t i;
+    };
+    typedef const_iterator iterator;
+
+    SampleSeries();
+
+    SampleSeries(const SampleSeries &other);
+
+    SampleSeries(SampleSeries &&other) noexcept;
+
+    SampleSeries &operator=(const SampleSeries &other);
+
+    SampleSeries &operator=(SampleSeries &&other) noexcept;
+
+    ~SampleSeries();
+
+    size_t size() const { return n; }
+
+    bool empty() const { return n == 0; }
+
+    size_t capacity() const { return cap; }
+
+    void reserve(size_t capacity);
+
+    /**
+     * new samples are zero
+     */
+    void resize(size_t size);
+
+    void clear() { n = 0; }
+
+    void push_back(const Eigen::Vector3d &v);
+
+    Ref operator[](size_t i) { return Ref(block + i, Eigen::InnerStride<>(cap)); }
+
+    ConstRef operator[](size_t i) const { return ConstRef(block + i, Eigen::InnerStride<>(cap)); }
+
+    Ref back() { return (*this)[n - 1]; }
+
+    ConstRef back() const { return (*this)[n - 1]; }
+
+    /**
+     * the contiguous series of one component, dim 0 to 2
+     */
+    double *data(int dim) { return block + dim * cap; }
+
+    const double *data(int dim) const { return block + dim * cap; }
+
+    /**
+     * appends the samples [first, last) of other
+     */
+    void append(const SampleSeries &other, size_t first, size_t last);
+
+    void append(const SampleSeries &other);
+
+    /**
+     * Replaces the storage with 3 * capacity doubles borrowed from an arena, capacity being
+     * a result of alignCapacity(). The series is sized to capacity samples.
+     */
+    void attach(double *storage, size_t capacity);
+
+    /**
+     * attaches storage that already holds size samples, which are left as they are
+     */
+    void attach(double *storage, size_t capacity, size_t size);
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    const_iterator end() const { return const_iterator(this, n); }
+
+    bool operator==(const SampleSeries &other) const;
+
+    bool operator!=(const SampleSeries &other) const { return !(*this == other); }
+
+    /**
+     * rounds a number of samples up so every component series fills whole cache lines
+     */
+    static size_t alignCapacity(size_t capacity) { return (capacity + 7) & ~(size_t) 7; }
+
+private:
+    double *block;
+    size_t n;
+    size_t cap;
+    bool owned;
+
+    void reallocate(size_t capacity);
+
+    void release();
+};
+
+#endif
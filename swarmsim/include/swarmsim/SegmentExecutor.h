@@ -0,0 +1,46 @@
+#ifndef SEGMENT_EXECUTOR_H
+#define SEGMENT_EXECUTOR_H
+
+#include <mutex>
+#include "ros/ros.h"
+#include <std_msgs/Float64MultiArray.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <mavros_msgs/PositionTarget.h>
+#include "SegmentedTrajectory.h"
+
+/**
+ * Runs next to the autopilot of one drone and turns the segmented horizons the swarm sends
+ * on /<drone_id>/swarm/segments into setpoints at the control rate, so the swarm does not
+ * have to publish every setpoint itself.
+ */
+class SegmentExecutor {
+public:
+    /**
+     * feedforward: publish the velocity and acceleration of the segments along with the
+     * position on setpoint_raw/local, otherwise the position on setpoint_position/local
+     */
+    SegmentExecutor(int droneId, const ros::NodeHandle &n, bool feedforward);
+
+    /**
+     * publishes the setpoint at time now (s of ROS time), nothing before the first horizon starts
+     */
+    void tick(double now);
+
+private:
+    int droneId;
+    bool feedforward;
+    ros::NodeHandle nh;
+    ros::Subscriber segmentsSub;
+    ros::Publisher posSetPointPub;
+    ros::Publisher rawSetPointPub;
+    //reused by every tick
+    geometry_msgs::PoseStamped setpointMsg;
+    mavros_msgs::PositionTarget targetMsg;
+    //filled by the subscription callback, sampled by the control loop
+    std::mutex scheduleMutex;
+    SegmentSchedule schedule;
+
+    void segmentsCB(const std_msgs::Float64MultiArrayConstPtr &msg);
+};
+
+#endif
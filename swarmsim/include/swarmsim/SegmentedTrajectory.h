@@ -0,0 +1,89 @@
+#ifndef SEGMENTED_TRAJECTORY_H
+#define SEGMENTED_TRAJECTORY_H
+
+#include <eigen3/Eigen/Dense>
+#include <map>
+#include <vector>
+#include "Trajectory.h"
+
+using namespace std;
+
+/**
+ * Cubic polynomial of every axis over [0, duration] seconds:
+ * p(t) = coeffs[axis][0] + coeffs[axis][1] t + coeffs[axis][2] t^2 + coeffs[axis][3] t^3
+ */
+struct PolynomialSegment {
+    double duration;
+    double coeffs[3][4];
+
+    TrajectoryState evaluate(double t) const;
+};
+
+/**
+ * A sampled trajectory compressed into cubic segments, sent to the drone once per horizon
+ * instead of one setpoint per control tick. start is the time of its first sample on the
+ * clock shared with the executor, trajectoryId the horizon it belongs to.
+ */
+class SegmentedTrajectory {
+public:
+    int trajectoryId;
+    double start;
+    vector<PolynomialSegment> segments;
+
+    SegmentedTrajectory();
+
+    /**
+     * Fits Hermite segments through samples of tr, taken sampleRate times a second, so that no
+     * sample is further than tolerance (m) from the segments. Knots are placed greedily, as far
+     * apart as the tolerance allows. offset is added to every position, e.g. to move the
+     * trajectory into the local frame of the drone.
+     */
+    static SegmentedTrajectory fit(const Trajectory &tr, double sampleRate, double tolerance,
+                                   const Eigen::Vector3d &offset = Eigen::Vector3d::Zero());
+
+    double getDuration() const;
+
+    /**
+     * state t seconds after start, clamped to the segments
+     */
+    TrajectoryState evaluate(double t) const;
+
+    /**
+     * flat layout for a std_msgs/Float64MultiArray:
+     * trajectoryId, start, n, then duration and the 12 coefficients of each of the n segments
+     */
+    void encode(vector<double> &out) const;
+
+    /**
+     * returns false if in is not a complete encoding
+     */
+    static bool decode(const vector<double> &in, SegmentedTrajectory &tr);
+
+private:
+    //start of every segment relative to start, rebuilt by fit and decode
+    vector<double> offsets;
+
+    void index();
+};
+
+/**
+ * The segmented trajectories received by an executor. Every horizon takes over from the
+ * previous one at its start; resending a horizon, e.g. after a splice, replaces it.
+ */
+class SegmentSchedule {
+public:
+    void insert(const SegmentedTrajectory &tr);
+
+    /**
+     * State at time now of the latest horizon that started. Horizons it took over from are
+     * dropped. Returns false if none started yet.
+     */
+    bool sample(double now, TrajectoryState &state);
+
+    size_t size() const;
+
+private:
+    map<int, SegmentedTrajectory> horizons;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SEQLOCK_SLOT_H
+#define SEQLOCK_SLOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/**
+ * Single writer, multiple reader slot holding the latest value of T. The writer never
+ * blocks and readers retry while a store is in progress, so a callback thread can hand
+ * its newest sample to the control loop without a lock. T must be trivially copyable.
+ */
+template<typename T>
+class SeqlockSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "a seqlock slot copies its value byte by byte");
+
+public:
+    SeqlockSlot() : seq(0) {
+        memset(&value, 0, sizeof(T));
+    }
+
+    SeqlockSlot(const SeqlockSlot &) = delete;
+
+    SeqlockSlot &operator=(const SeqlockSlot &) = delete;
+
+    /**
+     * only one thread may store into a slot
+     */
+    void store(const T &v) {
+        uint64_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &v, sizeof(T));
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * copies the latest value into out. Returns false if nothing was stored yet
+     */
+    bool load(T &out) const {
+        for (;;) {
+            uint64_t s = seq.load(std::memory_order_acquire);
+            if (s & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            memcpy(&out, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s) {
+                return s != 0;
+            }
+        }
+    }
+
+private:
+    std::atomic<uint64_t> seq;
+    T value;
+};
+
+#endif
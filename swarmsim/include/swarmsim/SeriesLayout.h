@@ -0,0 +1,29 @@
+#ifndef SERIES_LAYOUT_H
+#define SERIES_LAYOUT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "SampleSeries.h"
+
+/**
+ * Helpers for the files that lay the trajectories out as one 64 byte aligned series of
+ * doubles per component: the compiled missions and the trajectory registry.
+ */
+namespace serieslayout {
+    inline uint64_t align64(uint64_t offset) {
+        return (offset + 63) & ~(uint64_t) 63;
+    }
+
+    /**
+     * copies n samples of one component. Missing samples, such as the derivatives of
+     * position only trajectories, are zero
+     */
+    inline void copyComponent(const SampleSeries &series, int dim, int n, double *out) {
+        int available = std::min<int>(n, series.size());
+        std::memcpy(out, series.data(dim), available * sizeof(double));
+        std::fill(out + available, out + n, 0.0);
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SETPOINT_LOOP_H
+#define SETPOINT_LOOP_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Timing of the loop since the previous report. Lateness is how far past its deadline a
+ * tick started, in seconds. Overruns count the deadlines skipped because a tick ran too long.
+ */
+struct LoopStats {
+    uint64_t ticks;
+    uint64_t overruns;
+    double meanLateness;
+    double maxLateness;
+};
+
+/**
+ * Runs a tick at a fixed rate on a dedicated thread. Deadlines are absolute on the
+ * monotonic clock, so the time a tick takes does not shift the following ones, and a
+ * late tick does not trigger a burst of catch up ticks. The thread can be pinned to a
+ * core and scheduled SCHED_FIFO to keep the setpoints clear of the supervisory work.
+ */
+class SetpointLoop {
+public:
+    /**
+     * rate: ticks per second
+     * cpu: core to pin the thread to, -1 leaves it to the scheduler
+     * priority: SCHED_FIFO priority (1-99), 0 keeps the default scheduler
+     */
+    SetpointLoop(double rate, function<void()> tick, int cpu = -1, int priority = 0);
+
+    ~SetpointLoop();
+
+    SetpointLoop(const SetpointLoop &) = delete;
+
+    SetpointLoop &operator=(const SetpointLoop &) = delete;
+
+    void start();
+
+    /**
+     * returns once the tick in progress finished
+     */
+    void stop();
+
+    /**
+     * the counters since the previous call
+     */
+    LoopStats getStats();
+
+    string report();
+
+private:
+    int64_t periodNs;
+    function<void()> tick;
+    int cpu;
+    int priority;
+    atomic<bool> stopped;
+    thread loop;
+    atomic<uint64_t> ticks;
+    atomic<uint64_t> overruns;
+    atomic<uint64_t> totalLatenessNs;
+    atomic<uint64_t> maxLatenessNs;
+
+    void run();
+
+    /**
+     * applies the affinity and the scheduling policy to the calling thread. Failures, e.g. a
+     * missing CAP_SYS_NICE, are reported and the loop runs without them.
+     */
+    void configureThread();
+};
+
+#endif
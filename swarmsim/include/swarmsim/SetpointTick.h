@@ -0,0 +1,46 @@
+#ifndef SETPOINT_TICK_H
+#define SETPOINT_TICK_H
+
+#include <ros/time.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <mavros_msgs/PositionTarget.h>
+#include "TrajectoryQueue.h"
+
+/**
+ * The part of a control tick of a drone that needs no node: samples its trajectory queue and
+ * fills the setpoint it publishes. The messages are reused from tick to tick, so a tick does not
+ * allocate. Drone::executeTrajectory publishes what update fills.
+ */
+class SetpointTick {
+public:
+    SetpointTick();
+
+    /**
+     * velocity and acceleration feedforward in targetMsg instead of a position in setpointMsg
+     */
+    bool feedforward;
+
+    /**
+     * the executor of the drone samples the segments itself, update only tracks the progress
+     */
+    bool segmentExecution;
+
+    /**
+     * reference of the last update and its position in the local frame of the drone
+     */
+    TrajectoryState reference;
+    Eigen::Vector3d waypoint;
+
+    geometry_msgs::PoseStamped setpointMsg;
+    mavros_msgs::PositionTarget targetMsg;
+
+    /**
+     * Samples queue at now (s), see TrajectoryQueue::sample, and fills the message the drone
+     * publishes. home is the origin of the local frame of the drone and stamp the time of the
+     * target. Returns false once the last queued trajectory ended, the setpoint then holds its
+     * last sample.
+     */
+    bool update(TrajectoryQueue &queue, double now, double sampleRate, const Eigen::Vector3d &home, const ros::Time &stamp);
+};
+
+#endif
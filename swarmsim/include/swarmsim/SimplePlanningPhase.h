@@ -1,5 +1,7 @@
 #include "PlanningPhase.h"
 #include "utils.h"
+#include "IndexedMission.h"
+#include <memory>
 
 /**
  * This implementation loads the discrete waypoints from a yaml file instead of doing
@@ -8,11 +10,19 @@
 class SimplePlanningPhase : public PlanningPhase {
     public:
         string yamlFpath;
-        promise<vector<Trajectory> > p;
+        promise<vector<TrajectoryPtr> > p;
         SimplePlanningPhase();
         SimplePlanningPhase(int nDrones, double frequency, string yamlFpath);
-        void doPlanning(int horizonId,std::vector<Trajectory> prevPlan) override;
-        YamlDescriptor yamlDescriptor;
+        /**
+         * joins the planning thread while the mission it reads is still there
+        */
+        ~SimplePlanningPhase() override;
+        void doPlanning(int horizonId, std::vector<TrajectoryPtr> prevPlan,
+                        vector<Eigen::Vector3d> expectedStart) override;
+        /**
+         * indexed on the first horizon. Holds the planned horizon and the lookahead horizons
+        */
+        unique_ptr<IndexedMission> mission;
         /**
          * Returns the discrete waypoints from the yaml file
         */
@@ -0,0 +1,58 @@
+#ifndef STATE_COUNTERS_H
+#define STATE_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include "state.h"
+
+/**
+ * Number of drones in every state. Drones report their transitions as they happen, from
+ * whichever thread makes them, so the swarm finds out whether all drones share a state in
+ * O(1) instead of polling each of them every tick.
+ */
+class StateCounters {
+public:
+    StateCounters() : transitions(0) {
+        for (std::atomic<int> &count : counts) {
+            count = 0;
+        }
+    }
+
+    StateCounters(const StateCounters &) = delete;
+
+    StateCounters &operator=(const StateCounters &) = delete;
+
+    /**
+     * from is -1 for a drone that had no state yet
+     */
+    void transition(int from, int to) {
+        if (from == to) {
+            return;
+        }
+        //count the new state first, so a reader never sees a drone in no state at all
+        if (to >= 0 && to < NStates) {
+            counts[to].fetch_add(1);
+        }
+        if (from >= 0 && from < NStates) {
+            counts[from].fetch_sub(1);
+        }
+        transitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int count(int state) const {
+        return state >= 0 && state < NStates ? counts[state].load() : 0;
+    }
+
+    /**
+     * total number of transitions reported, e.g. to see whether anything changed since a tick
+     */
+    uint64_t getTransitions() const {
+        return transitions.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> counts[NStates];
+    std::atomic<uint64_t> transitions;
+};
+
+#endif
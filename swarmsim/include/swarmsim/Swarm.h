@@ -5,11 +5,24 @@
 #include <mavros_msgs/CommandTOL.h>
 #include <mavros_msgs/SetMode.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <nav_msgs/Path.h>
 #include "Drone.h"
 #include "Trajectory.h"
 #include <future>
 #include "SimplePlanningPhase.h"
 #include "Visualize.h"
+#include "CompiledMission.h"
+#include "FlightRecorder.h"
+#include "MissionCheckpoint.h"
+#include "TrajectoryRegistry.h"
+#include "MemoryAccounting.h"
+#include "CallbackShards.h"
+#include "SetpointLoop.h"
+#include "CpuUsage.h"
+#include "Heartbeat.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
 
 class Swarm {
 public:
@@ -17,61 +30,271 @@ public:
 
     Swarm(const ros::NodeHandle &n, double frequency, int n_drones, string &yamlFilePath, string &yamlFileName, bool visualizaTraj, string& obstacleFileName);
 
+/**
+ * Flies a mission solved offline by swarmsim_mission_compiler. Nothing is planned; each
+ * horizon is read from the mapped file one horizon ahead of its execution.
+ */
+    Swarm(const ros::NodeHandle &n, double frequency, shared_ptr<CompiledMission> mission, bool visualizaTraj);
+
+    /**
+     * stops the loops and releases the drones before the queues and the dispatcher they use
+     */
+    ~Swarm();
+
+    /**
+     * supervisory loop: state machine transitions, planning handoff and checkpoints.
+     * Runs at supervisorRate on the ROS spinner.
+     */
     void iteration(const ros::TimerEvent &e);
 
+    /**
+     * draws the markers and publishes the global poses at visualizationRate
+     */
+    void visualize(const ros::TimerEvent &e);
+
+    /**
+     * Builds the swarm the params of n describe: a compiled mission, a planned one or
+     * predefined trajectories. Returns nullptr if the mission cannot be loaded.
+     */
+    static Swarm *create(const ros::NodeHandle &n, double frequency);
+
+    /**
+     * false if the mission could not be loaded or its first horizon could not be planned
+     */
+    bool isLoaded();
+
+    /**
+     * Starts the setpoint thread at setpointRate (frequency by default) and the supervisory and
+     * visualization timers, which run on the callback queue of the node handle. Returns at once,
+     * e.g. for a nodelet.
+     */
+    void start(float frequency);
+
+    void stop();
+
+    /**
+     * start, then spins until shutdown
+     */
     void run(float frequency);
 
 /**
- * This function sets wpts and tlist for the next horizon. The idea is to
- * let external parties to set waypoints for the swarm as long as the swarm is
- * in the planning phase.
+ * This function queues new subgoals for the next planned horizon. The idea is to
+ * let external parties (eg: a local publisher) stream waypoints into the running swarm.
+ * droneWpts[i].pos holds the subgoals of drone i and tList the time to reach each of them.
+ * Drones with no subgoals keep their mission waypoints. Safe to call from any thread.
  */
     void setWaypoints(vector<Trajectory> droneWpts, vector<double> tList);
 
+    void setWaypoints(int droneId, Trajectory wpts);
+
+/**
+ * Replans the rest of the current horizon through new via points without waiting for the
+ * next horizon. viaWpts[i].pos holds the via points of drone i and tList the time to reach
+ * each of them; drones with no via points keep their plan. The new trajectories start from
+ * the full state leadTime seconds ahead and rejoin the current plan at the end of the horizon,
+ * so the queued horizons stay continuous. The splice is adopted as soon as it is solved,
+ * provided the drones have not passed the splice point by then.
+ */
+    bool spliceWaypoints(vector<Trajectory> viaWpts, double leadTime);
+
 private:
     double planExecutionRatio;
     bool predefined;
     int phase;
-    int state;
+    atomic<int> state;
     ros::NodeHandle nh;
     float frequency;
     int n_drones;
     std::vector<Drone *> dronesList;
-    //stores the incoming wpts
-    std::vector<Trajectory> wpts;
-    std::vector<Trajectory> prevTrl;
-    
-    std::vector<double> tList;
+    std::vector<TrajectoryPtr> prevTrl;
+    std::vector<ros::Subscriber> waypointSubs;
+    bool splicePending;
+    future<vector<TrajectoryPtr> > spliceFut;
+    std::vector<int> spliceDrones;
+    std::vector<int> spliceIdx;
+    std::vector<int> spliceTrajectoryIds;
     int horizonLen;
-    PlanningPhase *planningPhase;
+    PlanningPhase *planningPhase = nullptr;
     bool planningInitialized;
     bool executionInitialized;
     int horizonId;
     ros::Publisher swarmStatePub;
     bool visualizeTraj;
-    Visualize *vis;
+    bool loaded = true;
+    Visualize *vis = nullptr;
+    shared_ptr<CompiledMission> compiledMission;
+    int compiledHorizons;
+    unique_ptr<FlightRecorder> recorder;
+    unique_ptr<CommandDispatcher> dispatcher;
+    /**
+     * queues and spinner threads serving the drone subscriptions (null to serve them on the
+     * global queue) and the seconds between their reports in the log (0 disables them)
+     */
+    unique_ptr<CallbackShards> callbackShards;
+    unique_ptr<SetpointLoop> setpointLoop;
+    ros::Timer supervisorTimer;
+    ros::Timer visTimer;
+    //trajectory id << 32 | execPointer of the last drone, written by the setpoint thread
+    atomic<uint64_t> setpointProgress;
+    int phaseTrajectoryId;
+    double setpointReportPeriod;
+    double lastSetpointReport;
+    double callbackReportPeriod;
+    double lastCallbackReport;
+    /**
+     * whether the drones publish velocity and acceleration feedforward with their setpoints,
+     * and the seconds between the tracking error reports in the log (0 disables them)
+     */
+    bool feedforward;
+    //the drones execute their horizons from polynomial segments, see Drone::setSegmentExecution
+    bool segmentExecution;
+    double trackingReportPeriod;
+    double lastTrackingReport;
+    ros::Subscriber modelStatesSub;
+    //gazebo model name to drone id, and the index of every drone in the last model_states message
+    unordered_map<string, int> modelIds;
+    vector<int> modelIndex;
+    size_t indexedModels;
+    unique_ptr<TrajectoryRegistry> registry;
+    string missionPath;
+    string checkpointPath;
+    double checkpointPeriod;
+    double lastCheckpoint;
+    future<void> checkpointFut;
+    /**
+     * seconds between the live memory reports in the log (0 disables them)
+     */
+    double memoryReportPeriod;
+    double lastMemoryReport;
+    /**
+     * seconds between the CPU usage reports in the log (0 disables them). They cover this
+     * process and the processes the cpuProcesses param names, e.g. [segment_executor]
+     */
+    double cpuReportPeriod;
+    double lastCpuReport;
+    CpuUsage cpuUsage;
+    //drones per state, kept up to date by the drones themselves
+    StateCounters stateCounters;
+    /**
+     * swarm/state is published when the state changes and again every stateHeartbeatPeriod
+     * seconds (0 disables the heartbeat), on the clock of the supervisory timer events
+     */
+    Heartbeat stateHeartbeat;
 
     /**
      * check the swarm for a given state.
      * The swarm is in a state if all the drones are in the same state
+     * now: time of the supervisory tick
     */
-    void checkSwarmForStates(int state);
+    void checkSwarmForStates(int state, double now);
 
-    void setState(int state);
+    /**
+     * publishes the swarm state on the latched swarm/state topic, now is the time of the
+     * supervisory tick
+     */
+    void publishState(double now);
+
+    void setState(int state, double now);
 
     void armDrones(bool arm);
 
     void TOLService(bool takeoff);
 
+    /**
+     * publishes the setpoints of all drones for the current time of the steady clock, or
+     * tracks their progress on the ROS clock if the drones execute segments
+     */
     void sendPositionSetPoints();
 
     /**
-     * calculates the swarm phase for the swarm based on the horizon length and current time
+     * calculates the swarm phase for the swarm based on the horizon length and the
+     * progress published by the setpoint thread
+     */
+    void setSwarmPhase();
+
+    /**
+     * starts planning the next horizon or commits its plan, depending on the phase.
+     * now: time of the supervisory tick, also the stamp of the checkpoint saved at a commit
+     */
+    void performPhaseTasks(double now);
+
+    /**
+     * hands a solved splice over to the drones
      */
-    void setSwarmPhase(int execPointer);
+    void performSpliceTasks();
 
-    void performPhaseTasks();
+    /**
+     * pushes the next compiled horizon once the drones start on the last pushed one
+     */
+    void performCompiledTasks();
+
+    void pushCompiledHorizon();
 
     void initVariables();
 
+    /**
+     * rms and max tracking error of the swarm since the start of the mission
+     */
+    string trackingReport();
+
+    /**
+     * subscribes once to the gazebo model states for the whole swarm and waits for the simulation
+     */
+    void initModelStates();
+
+    /**
+     * hands every drone the pose of its model until all of them have recorded their home
+     */
+    void modelStatesCB(const gazebo_msgs::ModelStatesConstPtr &msg);
+
+    /**
+     * starts the flight recorder if the flightLog parameter names a log file
+     */
+    void initRecorder();
+
+    void recordPlanningEvent(PlanningEvent event, int horizonId);
+
+    /**
+     * creates the shared memory registry if the trajectoryRegistry parameter names one
+     */
+    void initRegistry();
+
+    /**
+     * where every drone is expected to start the next horizon to be planned
+     */
+    vector<Eigen::Vector3d> getExpectedStart();
+
+    /**
+     * makes the trajectories of a horizon visible to the registry readers
+     */
+    void publishPlan(int horizonId, const vector<TrajectoryPtr> &plan);
+
+    /**
+     * Restores the drones and the planning progress from the checkpoint parameter.
+     * Returns false if there is no usable checkpoint for this mission.
+     */
+    bool resumeFromCheckpoint();
+
+    /**
+     * Snapshots the drones and writes the checkpoint on a background thread. Skipped
+     * while the previous checkpoint is still being written.
+     */
+    void saveCheckpoint(double stamp);
+
+    /**
+     * removes the checkpoint once the mission is complete
+     */
+    void clearCheckpoint();
+
+    /**
+     * subscribes waypoints/<id> for every drone. See waypointsCB for the message layout.
+     */
+    void initWaypointStreams();
+
+    /**
+     * poses[i].header.stamp holds the time at which subgoal i is to be reached,
+     * measured from the start of the horizon.
+     */
+    void waypointsCB(const nav_msgs::PathConstPtr &msg, int droneId);
+
 };
\ No newline at end of file
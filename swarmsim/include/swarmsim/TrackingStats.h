@@ -0,0 +1,28 @@
+#ifndef TRACKING_STATS_H
+#define TRACKING_STATS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <eigen3/Eigen/Dense>
+
+/**
+ * distance between the local position of a drone and the reference of its trajectory,
+ * taken at every setpoint the drone publishes
+ */
+struct TrackingStats {
+    uint64_t samples = 0;
+    double sumSq = 0;
+    double max = 0;
+    //local position minus reference at the latest setpoint
+    Eigen::Vector3d last = Eigen::Vector3d::Zero();
+
+    void add(const Eigen::Vector3d &error) {
+        last = error;
+        double norm = error.norm();
+        samples++;
+        sumSq += norm * norm;
+        max = std::max(max, norm);
+    }
+};
+
+#endif
@@ -4,15 +4,129 @@
 #include <iostream>
 #include <eigen3/Eigen/Dense>
 #include <vector>
+#include <algorithm>
+#include <memory>
+#include "SampleSeries.h"
+#include "TrajectoryArena.h"
 
 enum TrajContinuity {Continued = 0, Start, End};
 
+/**
+ * full state of a drone at one sample of a trajectory
+ */
+struct TrajectoryState {
+  Eigen::Vector3d pos;
+  Eigen::Vector3d vel;
+  Eigen::Vector3d acc;
+};
+
+/**
+ * pos, vel and acc are stored as structure of arrays. Waypoints grow sample by sample,
+ * solved trajectories are allocated once, all three series in one block of the arena of
+ * their horizon, which the trajectory keeps alive.
+ */
 struct Trajectory {
-  std::vector<Eigen::Vector3d> pos; 
-  std::vector<Eigen::Vector3d> vel;
-  std::vector<Eigen::Vector3d> acc;
+  std::shared_ptr<TrajectoryArena> arena;
+  SampleSeries pos;
+  SampleSeries vel;
+  SampleSeries acc;
   std::vector<double> tList;
+
+  Trajectory() = default;
+
+  /**
+   * Copies own their samples, so they neither pin nor depend on the arena of the original.
+   */
+  Trajectory(const Trajectory &other) : pos(other.pos), vel(other.vel), acc(other.acc), tList(other.tList) {}
+
+  Trajectory(Trajectory &&other) = default;
+
+  Trajectory &operator=(const Trajectory &other) {
+    if (this != &other) {
+      pos = other.pos;
+      vel = other.vel;
+      acc = other.acc;
+      tList = other.tList;
+      //released only once no series points into it anymore
+      arena.reset();
+    }
+    return *this;
+  }
+
+  Trajectory &operator=(Trajectory &&other) = default;
+
+  /**
+   * Sizes pos, vel and acc to nSamples samples taken from arena, to be filled by the caller.
+   * Without an arena the trajectory gets a block of its own.
+   */
+  void allocate(size_t nSamples, std::shared_ptr<TrajectoryArena> arena_ = nullptr) {
+    size_t capacity = SampleSeries::alignCapacity(std::max<size_t>(nSamples, 1));
+    if (!arena_) {
+      arena_ = std::make_shared<TrajectoryArena>(9 * capacity * sizeof(double));
+    }
+    double *block = arena_->allocate(9 * capacity);
+    pos.attach(block, capacity);
+    vel.attach(block + 3 * capacity, capacity);
+    acc.attach(block + 6 * capacity, capacity);
+    pos.resize(nSamples);
+    vel.resize(nSamples);
+    acc.resize(nSamples);
+    arena = std::move(arena_);
+  }
+
+  /**
+   * state at sample idx. Trajectories loaded from position files have no
+   * derivatives, which are reported as zero.
+   */
+  TrajectoryState getState(int idx) const {
+    TrajectoryState s;
+    s.pos = pos[idx];
+    s.vel = Eigen::Vector3d::Zero();
+    s.acc = Eigen::Vector3d::Zero();
+    if (idx < (int) vel.size()) s.vel = vel[idx];
+    if (idx < (int) acc.size()) s.acc = acc[idx];
+    return s;
+  }
+
+  /**
+   * State t seconds after the first sample, for samples taken sampleRate times a second.
+   * Positions are cubic Hermite interpolated between the neighbouring samples using their
+   * velocities, velocities and accelerations linearly. t is clamped to the trajectory.
+   */
+  TrajectoryState interpolate(double t, double sampleRate) const {
+    int last = (int) pos.size() - 1;
+    double idx = std::min(std::max(t * sampleRate, 0.0), (double) last);
+    int i = std::min((int) idx, std::max(last - 1, 0));
+    double u = idx - i;
+    if (last < 1 || u <= 0) {
+      return getState(i);
+    }
+    if (u >= 1) {
+      return getState(i + 1);
+    }
+    TrajectoryState s0 = getState(i);
+    TrajectoryState s1 = getState(i + 1);
+    TrajectoryState s;
+    if (i + 1 < (int) vel.size()) {
+      double h = 1 / sampleRate;
+      double u2 = u * u;
+      double u3 = u2 * u;
+      s.pos = (2 * u3 - 3 * u2 + 1) * s0.pos + (u3 - 2 * u2 + u) * h * s0.vel
+              + (-2 * u3 + 3 * u2) * s1.pos + (u3 - u2) * h * s1.vel;
+    } else {
+      s.pos = (1 - u) * s0.pos + u * s1.pos;
+    }
+    s.vel = (1 - u) * s0.vel + u * s1.vel;
+    s.acc = (1 - u) * s0.acc + u * s1.acc;
+    return s;
+  }
 };
 
+/**
+ * Solved trajectories are immutable once produced and shared between the planner,
+ * the drones and the visualization instead of being copied at every hop.
+ */
+typedef std::shared_ptr<const Trajectory> TrajectoryPtr;
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef TRAJECTORY_ARENA_H
+#define TRAJECTORY_ARENA_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Bump allocator for the samples of the trajectories solved in one horizon. Every
+ * trajectory of the horizon is carved out of a few large blocks, which are freed together
+ * when the last trajectory referencing the arena is released.
+ */
+class TrajectoryArena {
+public:
+    /**
+     * blockSize: bytes requested from the heap at a time. Larger allocations get a block of their own.
+     */
+    explicit TrajectoryArena(size_t blockSize = 1 << 20);
+
+    ~TrajectoryArena();
+
+    TrajectoryArena(const TrajectoryArena &) = delete;
+
+    TrajectoryArena &operator=(const TrajectoryArena &) = delete;
+
+    /**
+     * 64 byte aligned storage for n doubles. Safe to call from any thread.
+     */
+    double *allocate(size_t n);
+
+    /**
+     * bytes held from the heap
+     */
+    size_t getReserved();
+
+private:
+    mutex arenaMutex;
+    vector<char *> blocks;
+    char *cur;
+    size_t left;
+    size_t blockSize;
+    size_t reserved;
+
+    char *allocateBlock(size_t size);
+};
+
+#endif
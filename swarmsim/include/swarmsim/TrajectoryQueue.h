@@ -0,0 +1,85 @@
+#ifndef TRAJECTORY_QUEUE_H
+#define TRAJECTORY_QUEUE_H
+
+#include <deque>
+#include "MissionCheckpoint.h"
+#include "Trajectory.h"
+
+using namespace std;
+
+/**
+ * The trajectory a drone is executing followed by the ones pushed for the next horizons, and
+ * its progress along them. Executed trajectories are retired from the front, trajectoryId is
+ * the horizon of the front one. Not synchronized, the drone guards it with its trajectoryMutex.
+ */
+class TrajectoryQueue {
+public:
+    TrajectoryQueue();
+
+    void push(TrajectoryPtr trajectory);
+
+    /**
+     * Reference at time now (s) of the swarm clock, interpolated between the samples, which are
+     * taken sampleRate times a second. The first call starts the timeline; a queued horizon
+     * takes over at the last sample of the one before it. Returns false once the last queued
+     * trajectory ended, reference is then its last sample.
+     */
+    bool sample(double now, double sampleRate, TrajectoryState &reference);
+
+    /**
+     * Finds the sample of the current trajectory ticksAhead samples from the current one.
+     * Returns false if the current trajectory ends before that.
+     */
+    bool getSplicePoint(int ticksAhead, int &spliceIdx, TrajectoryState &state) const;
+
+    /**
+     * Replaces the current trajectory from spliceIdx onwards with splice, whose first sample
+     * must be the state at spliceIdx. Returns false if trajectoryId is not the current
+     * trajectory or spliceIdx was already passed.
+     */
+    bool splice(const Trajectory &splice, int trajectoryId, int spliceIdx);
+
+    const TrajectoryPtr &getCurrent() const;
+
+    const TrajectoryPtr &getLast() const;
+
+    /**
+     * i-th queued trajectory, 0 being the current one
+     */
+    const TrajectoryPtr &get(size_t i) const;
+
+    size_t size() const;
+
+    int getTrajectoryId() const;
+
+    /**
+     * sample of the current trajectory at or before the time of the last sample() call
+     */
+    int getExecPointer() const;
+
+    /**
+     * swarm clock time of the first sample of the current trajectory, negative until sampled
+     */
+    double getStart() const;
+
+    /**
+     * sets the progress and the trajectories of checkpoint, shares the trajectories instead of copying them
+     */
+    void getCheckpoint(DroneCheckpoint &checkpoint) const;
+
+    /**
+     * continues from the progress of checkpoint. The timeline starts again with the next sample() call
+     */
+    void restore(const DroneCheckpoint &checkpoint);
+
+private:
+    deque<TrajectoryPtr> trajectories;
+    TrajectoryPtr trajectory;
+    int trajectoryId;
+    int execPointer;
+    double start;
+
+    void setCurrent(TrajectoryPtr trajectory);
+};
+
+#endif
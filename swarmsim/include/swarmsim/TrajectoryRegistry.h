@@ -0,0 +1,118 @@
+#ifndef TRAJECTORY_REGISTRY_H
+#define TRAJECTORY_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Trajectory.h"
+#include "CompiledMission.h"
+
+using namespace std;
+
+/**
+ * Layout of the registry in shared memory. Every block starts on a 64 byte boundary:
+ *   TrajectoryRegistryHeader
+ *   per drone a slot of slotSize bytes: RegistrySlot followed by the nine series of
+ *   capacity doubles, in CompiledSeries order
+ * generation counts the published horizons.
+ */
+struct TrajectoryRegistryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nDrones;
+    uint32_t capacity;
+    uint32_t reserved;
+    double frequency;
+    uint64_t slotSize;
+    atomic<uint64_t> generation;
+};
+
+/**
+ * seq is odd while the slot is being written and 0 until it is written once
+ */
+struct RegistrySlot {
+    atomic<uint64_t> seq;
+    int32_t horizonId;
+    uint32_t nSamples;
+};
+
+/**
+ * Publishes the planned trajectories into POSIX shared memory, so processes on the same
+ * host (test harnesses, visualizers, monitors) can read the current plans without parsing
+ * the mission or subscribing to ROS topics.
+ * There is one writer, the swarm, and any number of readers. Each drone slot is guarded by
+ * a sequence counter: readers never block the writer and retry when a slot changed while
+ * they were reading it.
+ */
+class TrajectoryRegistry {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Creates the registry for the writer, replacing a stale one of the same name.
+     * name is a shared memory name such as /swarmsim_trajectories, capacity the number of
+     * samples kept per trajectory. Throws runtime_error on failure.
+     */
+    TrajectoryRegistry(const string &name, int nDrones, int capacity, double frequency);
+
+    /**
+     * Opens an existing registry read only. Throws runtime_error if it does not exist.
+     */
+    explicit TrajectoryRegistry(const string &name);
+
+    /**
+     * unmaps the registry. The writer also removes the name.
+     */
+    ~TrajectoryRegistry();
+
+    TrajectoryRegistry(const TrajectoryRegistry &) = delete;
+
+    TrajectoryRegistry &operator=(const TrajectoryRegistry &) = delete;
+
+    int getDrones() const;
+
+    int getCapacity() const;
+
+    double getFrequency() const;
+
+    uint64_t getGeneration() const;
+
+    /**
+     * Writes plan[k] into the slot of drone k. Samples past the capacity are dropped.
+     */
+    void publish(int horizonId, const vector<TrajectoryPtr> &plan);
+
+    /**
+     * Zero copy reads. beginRead waits out a write in progress and returns the sequence
+     * to pass to endRead; the slot accessors are only valid if endRead then returns true.
+     */
+    uint64_t beginRead(int droneId) const;
+
+    bool endRead(int droneId, uint64_t seq) const;
+
+    int getHorizonId(int droneId) const;
+
+    int getSamples(int droneId) const;
+
+    const double *getSeries(int droneId, int series) const;
+
+    /**
+     * Copies a consistent trajectory out of the slot of drone droneId. Returns false if
+     * nothing was published for it yet.
+     */
+    bool read(int droneId, int &horizonId, Trajectory &tr) const;
+
+private:
+    string name;
+    bool owner;
+    char *base;
+    size_t length;
+    TrajectoryRegistryHeader *header;
+
+    RegistrySlot *getSlot(int droneId) const;
+
+    double *getSlotSeries(int droneId, int series) const;
+};
+
+#endif
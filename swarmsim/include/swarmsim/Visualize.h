@@ -5,6 +5,7 @@
 #include "Trajectory.h"
 #include "Obstacle.h"
 #include <geometry_msgs/Point.h>
+#include <boost/circular_buffer.hpp>
 
 using namespace std;
 using namespace Eigen;
@@ -12,7 +13,9 @@ using namespace Eigen;
 class Visualize {
     public:
         Visualize(ros::NodeHandle nh, string worldframe, int ndrones, string obstacleConfigFilePath);
-        void addToPaths(vector<Trajectory> trajs);
+        Visualize(ros::NodeHandle nh, string worldframe, int ndrones, vector<Obstacle> obstacles);
+        ~Visualize();
+        void addToPaths(const vector<TrajectoryPtr> &trajs);
         void draw();
         void addToGrid(std::vector<geometry_msgs::Point>);
         void addStartGoal(std::vector<geometry_msgs::Point>);
@@ -39,12 +42,31 @@ class Visualize {
         visualization_msgs::Marker topoMarker;
 
 
+        typedef boost::circular_buffer<geometry_msgs::Point> PointRing;
+
+        //every marker keeps its newest maxPoints points, so a long mission draws a sliding window.
+        //They are collected in rings and copied into the markers when these are drawn
+        size_t maxPoints;
+        vector<PointRing> trajPoints;
+        vector<PointRing> agentPathPoints;
+        PointRing gridPoints;
+        PointRing startPoints;
+        PointRing topoPoints;
+        //bytes reported to MemoryAccounting for the points of the markers and for the rings,
+        //the rings are counted once when their capacity is set
+        size_t accountedBytes;
+        size_t ringBytes;
+
         string obstacleConfigFilePath;
         std::vector<Obstacle> obstacles;
 
         void initMarkers();
-        std::vector<Obstacle> readObstacleConfig();
+        static std::vector<Obstacle> readObstacleConfig(const string &obstacleConfigFilePath);
         void populateObstacles();
+        void appendPoints(PointRing &ring, const std::vector<geometry_msgs::Point> &pts);
+        static void copyPoints(const PointRing &ring, std::vector<geometry_msgs::Point> &points);
+        //recounts the points of the markers
+        void updateAccounting();
 
         // void addToPaths(std::vector<Trajectory>);
         void drawAssignments();
@@ -0,0 +1,16 @@
+#ifndef WAYPOINT_UPDATE_H
+#define WAYPOINT_UPDATE_H
+
+#include "Trajectory.h"
+
+/**
+ * New subgoals for one drone, applied to the next horizon that is planned.
+ * wpts.pos holds the subgoals and wpts.tList the time to reach each of them,
+ * so both have the same length. The drone starts from the end of its current plan.
+ */
+struct WaypointUpdate {
+    int droneId;
+    Trajectory wpts;
+};
+
+#endif
@@ -1,3 +1,6 @@
+#ifndef YAML_DESCRIPTOR_H
+#define YAML_DESCRIPTOR_H
+
 #include <iostream>
 #include "Trajectory.h"
 #include <vector>
@@ -12,17 +15,17 @@ class YamlDescriptor{
         void setHorizons(int nHorizons);
         void setDrones(int nDrones);
         void setSubGoals(int nSubgoals);
-        int getSubGoals();
+        int getSubGoals() const;
         void setTimesArray(vector<HorizonTimes> timesArray);
-        vector<HorizonTimes> getTimesArray();
+        const vector<HorizonTimes> &getTimesArray() const;
         void setDronesTrajectories(vector<DroneTrajectory> dronesTr);
-        vector<DroneTrajectory> getdroneTrajectories();
-        int getHorizons();
-        int getDrones();
+        const vector<DroneTrajectory> &getdroneTrajectories() const;
+        int getHorizons() const;
+        int getDrones() const;
         void setHoveringThreshold(double val);
         void setMovingThreshold(double val);
-        double getHoveringThreshold();
-        double getMovingThreshold();
+        double getHoveringThreshold() const;
+        double getMovingThreshold() const;
 
     private:
         double movingThreshold;
@@ -34,4 +37,6 @@ class YamlDescriptor{
         double passThresholdMoving;
         double passThresholdHover;
         vector<DroneTrajectory> droneTrajectories; 
-};
\ No newline at end of file
+};
+
+#endif
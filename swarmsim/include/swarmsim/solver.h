@@ -2,8 +2,10 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <functional>
 // #include <qpOASES.hpp>
 #include "Trajectory.h"
+#include "Partitioner.h"
 #include <mav_trajectory_generation/polynomial_optimization_nonlinear.h>
 #include <mav_trajectory_generation_ros/ros_visualization.h>
 #include <mav_trajectory_generation_ros/ros_conversions.h>
@@ -14,7 +16,28 @@ using namespace Eigen;
 class Solver {
     public:
         Solver(int nDrones, double maxVel, double maxAcc, double frequency);
-        vector<Trajectory> solve(vector<Trajectory> droneWpts, bool initial, bool last, std::vector<Trajectory> prevPlan);
+
+        /**
+         * clustering parameters. Drones are grouped into cells of cellSize meters, each cluster
+         * is planned on its own worker thread and only drones whose regions cross clusters are
+         * checked against each other.
+         */
+        void setPartitioning(double cellSize, double minSeparation);
+
+        vector<TrajectoryPtr> solve(const vector<Trajectory> &droneWpts, bool initial, bool last,
+                                    const std::vector<TrajectoryPtr> &prevPlan);
+
+        /**
+         * plans between two full states. Position, velocity and acceleration of drone k are pinned
+         * to startStates[k] at its first waypoint and to endStates[k] at its last one.
+         */
+        vector<TrajectoryPtr> solve(const vector<Trajectory> &droneWpts, const vector<TrajectoryState> &startStates,
+                                    const vector<TrajectoryState> &endStates);
+
+        /**
+         * pairs of drones closer than minSeparation in the last solve
+         */
+        vector<pair<int, int> > getConflicts();
         
     private:
         int n = 7;
@@ -31,6 +54,16 @@ class Solver {
         MatrixXf getVelTimeVec(double t);
         MatrixXf getAccTimeVec(double t);
         Trajectory calculateTrajectoryWpts(mav_trajectory_generation::Trajectory& traj);
+        Trajectory solveDrone(const Trajectory &t_k, const mav_trajectory_generation::Vertex &start,
+                              const mav_trajectory_generation::Vertex &end);
+        vector<TrajectoryPtr> solveClusters(const vector<Trajectory> &droneWpts, const function<Trajectory(int)> &solveOne);
+        double cellSize = 10;
+        double minSeparation = 0.5;
+        vector<pair<int, int> > conflicts;
+        /**
+         * holds the samples of the horizon being solved
+         */
+        shared_ptr<TrajectoryArena> arena;
 
         int nwpts = 0;
 
@@ -1,6 +1,6 @@
 #ifndef state_h
 #define state_h
-enum States { Idle = 0, Ready, Armed, Takingoff, Autonomous, Reached };
+enum States { Idle = 0, Ready, Armed, Takingoff, Autonomous, Reached, NStates };
 enum Phases {Planning = 0, Optimization, Execution };
 #endif
 
@@ -8,6 +8,7 @@
 #include <future>
 #include <stdexcept>
 #include "YamlDescriptor.h"
+#include "Obstacle.h"
 
 using namespace std;
 
@@ -15,14 +16,30 @@ namespace simutils {
 
     void processYamlFile(char *fPath, YamlDescriptor &yamlDescriptor);
 
+    /**
+     * reads the obstacles of an obstacle config. Throws runtime_error if the file
+     * cannot be read or is malformed.
+     */
+    vector<Obstacle> readObstacleConfig(const string &fPath);
+
     vector<double> loadTimesFromFile(ros::NodeHandle &nh);
 
     vector<Trajectory> loadTrajectoriesFromFile(int n_drones, ros::NodeHandle &nh, string trajDir);
 
-    int getGazeboModelId(string* modelNames, string elementName);
+    /**
+     * Loads trajDir/pos_<i>.txt for every drone, on at most one thread per core. Each file is memory
+     * mapped and holds one "x y z" position per line. Throws runtime_error if a file
+     * cannot be read or holds something other than numbers.
+     */
+    vector<Trajectory> loadTrajectoriesFromFile(int n_drones, const string &trajDir);
 
-    void parseYamlHeader(char *fPath, YamlDescriptor &yamlDescriptor);
+    /**
+     * loads one position file. size is set to the file size in bytes
+     */
+    Trajectory loadTrajectoryFile(const string &fPath, size_t &size);
+
+    int getGazeboModelId(string* modelNames, string elementName);
 
-    vector<Trajectory> getHorizonTrajetories(int horizonId, YamlDescriptor yamlDescriptor);
+    vector<Trajectory> getHorizonTrajetories(int horizonId, const YamlDescriptor &yamlDescriptor);
 
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "CallbackShards.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+    template<typename T>
+    void storeMax(atomic<T> &max, T value) {
+        T cur = max.load(memory_order_relaxed);
+        while (value > cur && !max.compare_exchange_weak(cur, value, memory_order_relaxed)) {}
+    }
+}
+
+/**
+ * Wraps a queued callback to time its wait. A callback that is removed from the queue
+ * without running, e.g. when its subscriber shuts down, leaves the depth on destruction.
+ */
+class TimedCallback : public ros::CallbackInterface {
+public:
+    TimedCallback(ros::CallbackInterfacePtr callback, MonitoredCallbackQueue *queue)
+            : callback(move(callback)), queue(queue), queued(chrono::steady_clock::now()), started(false),
+              done(false) {}
+
+    ~TimedCallback() override {
+        if (!done) {
+            queue->finished();
+        }
+    }
+
+    CallResult call() override {
+        if (!started) {
+            queue->started(chrono::steady_clock::now() - queued);
+            started = true;
+        }
+        CallResult result = callback->call();
+        if (result != TryAgain && !done) {
+            done = true;
+            queue->finished();
+        }
+        return result;
+    }
+
+    bool ready() override {
+        return callback->ready();
+    }
+
+private:
+    ros::CallbackInterfacePtr callback;
+    MonitoredCallbackQueue *queue;
+    chrono::steady_clock::time_point queued;
+    bool started;
+    bool done;
+};
+
+MonitoredCallbackQueue::MonitoredCallbackQueue() : depth(0), maxDepth(0), callbacks(0), totalLatencyNs(0),
+                                                   maxLatencyNs(0) {}
+
+MonitoredCallbackQueue::~MonitoredCallbackQueue() {
+    clear();
+}
+
+void MonitoredCallbackQueue::addCallback(const ros::CallbackInterfacePtr &callback, uint64_t owner_id) {
+    storeMax(maxDepth, ++depth);
+    ros::CallbackQueue::addCallback(ros::CallbackInterfacePtr(new TimedCallback(callback, this)), owner_id);
+}
+
+CallbackStats MonitoredCallbackQueue::getStats() {
+    CallbackStats stats;
+    stats.depth = depth;
+    stats.maxDepth = maxDepth.exchange(depth);
+    stats.callbacks = callbacks.exchange(0);
+    uint64_t total = totalLatencyNs.exchange(0);
+    stats.meanLatency = stats.callbacks > 0 ? total / 1e9 / stats.callbacks : 0;
+    stats.maxLatency = maxLatencyNs.exchange(0) / 1e9;
+    return stats;
+}
+
+void MonitoredCallbackQueue::started(chrono::steady_clock::duration latency) {
+    uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(latency).count();
+    callbacks++;
+    totalLatencyNs += ns;
+    storeMax(maxLatencyNs, ns);
+}
+
+void MonitoredCallbackQueue::finished() {
+    depth--;
+}
+
+CallbackShards::CallbackShards(int nShards) {
+    for (int i = 0; i < max(nShards, 1); i++) {
+        queues.emplace_back(new MonitoredCallbackQueue());
+    }
+}
+
+CallbackShards::~CallbackShards() {
+    for (unique_ptr<ros::AsyncSpinner> &spinner : spinners) {
+        spinner->stop();
+    }
+}
+
+ros::CallbackQueue *CallbackShards::getQueue(int droneId) {
+    return queues[droneId % queues.size()].get();
+}
+
+void CallbackShards::start() {
+    for (unique_ptr<MonitoredCallbackQueue> &queue : queues) {
+        spinners.emplace_back(new ros::AsyncSpinner(1, queue.get()));
+        spinners.back()->start();
+    }
+}
+
+int CallbackShards::getShards() {
+    return queues.size();
+}
+
+CallbackStats CallbackShards::getStats(int shard) {
+    return queues[shard]->getStats();
+}
+
+string CallbackShards::report() {
+    ostringstream ss;
+    ss.precision(3);
+    for (size_t i = 0; i < queues.size(); i++) {
+        CallbackStats stats = queues[i]->getStats();
+        ss << (i > 0 ? ", " : "") << "shard " << i << ": depth " << stats.depth << " (max " << stats.maxDepth << "), "
+           << stats.callbacks << " callbacks, latency " << stats.meanLatency * 1e3 << " ms (max "
+           << stats.maxLatency * 1e3 << " ms)";
+    }
+    return ss.str();
+}
@@ -0,0 +1,142 @@
+#include "CommandDispatcher.h"
+#include <ros/console.h>
+#include <algorithm>
+#include <stdexcept>
+
+CommandDispatcher::CommandDispatcher(int nDrones, int nThreads, int maxAttempts, double retryDelay)
+        : nDrones(nDrones), maxAttempts(max(maxAttempts, 1)),
+          retryDelay(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(retryDelay))),
+          slots(nDrones * NCommandTypes, Slot{0, CommandIdle}), busy(nDrones, 0), scanned(nDrones, 0),
+          inFlight(0), stopped(false) {
+    for (int i = 0; i < max(nThreads, 1); i++) {
+        workers.emplace_back(&CommandDispatcher::workLoop, this);
+    }
+}
+
+CommandDispatcher::~CommandDispatcher() {
+    {
+        lock_guard<mutex> lock(dispatchMutex);
+        stopped = true;
+        if (!queue.empty()) {
+            ROS_WARN_STREAM("Dropping " << queue.size() << " drone commands");
+        }
+        queue.clear();
+    }
+    wakeup.notify_all();
+    for (thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void CommandDispatcher::dispatch(int droneId, CommandType type, function<bool()> call) {
+    if (droneId < 0 || droneId >= nDrones) {
+        throw out_of_range("No drone " + to_string(droneId) + " to send a command to");
+    }
+    {
+        lock_guard<mutex> lock(dispatchMutex);
+        queue.push_back(Command{droneId, type, move(call), 1, chrono::steady_clock::now()});
+        getSlot(droneId, type).outstanding++;
+    }
+    wakeup.notify_one();
+}
+
+CommandStatus CommandDispatcher::getStatus(int droneId, CommandType type) {
+    lock_guard<mutex> lock(dispatchMutex);
+    const Slot &slot = getSlot(droneId, type);
+    return slot.outstanding > 0 ? CommandPending : slot.last;
+}
+
+void CommandDispatcher::reset(int droneId, CommandType type) {
+    lock_guard<mutex> lock(dispatchMutex);
+    getSlot(droneId, type).last = CommandIdle;
+}
+
+int CommandDispatcher::getPending() {
+    lock_guard<mutex> lock(dispatchMutex);
+    return queue.size() + inFlight;
+}
+
+const char *CommandDispatcher::getName(CommandType type) {
+    switch (type) {
+        case ArmCommand:
+            return "arm";
+        case TakeoffCommand:
+            return "takeoff";
+        case LandCommand:
+            return "land";
+        case SetModeCommand:
+            return "set mode";
+        default:
+            return "unknown";
+    }
+}
+
+void CommandDispatcher::workLoop() {
+    unique_lock<mutex> lock(dispatchMutex);
+    while (!stopped) {
+        Command command;
+        chrono::steady_clock::time_point wakeAt;
+        if (!takeNext(command, wakeAt)) {
+            if (wakeAt == chrono::steady_clock::time_point::max()) {
+                wakeup.wait(lock);
+            } else {
+                wakeup.wait_until(lock, wakeAt);
+            }
+            continue;
+        }
+        busy[command.droneId] = 1;
+        inFlight++;
+        lock.unlock();
+        bool accepted = false;
+        try {
+            accepted = command.call();
+        }
+        catch (exception &e) {
+            ROS_ERROR_STREAM("Drone: " << command.droneId << " " << getName(command.type) << " command threw. "
+                                       << e.what());
+        }
+        lock.lock();
+        busy[command.droneId] = 0;
+        inFlight--;
+        Slot &slot = getSlot(command.droneId, command.type);
+        if (accepted) {
+            slot.outstanding--;
+            slot.last = CommandSucceeded;
+        } else if (command.attempt < maxAttempts && !stopped) {
+            ROS_WARN_STREAM("Drone: " << command.droneId << " " << getName(command.type) << " command failed. Retry "
+                                      << command.attempt << " of " << maxAttempts - 1);
+            command.attempt++;
+            command.notBefore = chrono::steady_clock::now() + retryDelay;
+            //retries go first so the later commands of the drone keep waiting behind them
+            queue.push_front(move(command));
+        } else {
+            ROS_ERROR_STREAM("Drone: " << command.droneId << " " << getName(command.type) << " command failed after "
+                                       << command.attempt << " attempts");
+            slot.outstanding--;
+            slot.last = CommandFailed;
+        }
+        //the drone may have later commands waiting for this one
+        wakeup.notify_all();
+    }
+}
+
+bool CommandDispatcher::takeNext(Command &command, chrono::steady_clock::time_point &wakeAt) {
+    wakeAt = chrono::steady_clock::time_point::max();
+    auto now = chrono::steady_clock::now();
+    fill(scanned.begin(), scanned.end(), 0);
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        int droneId = it->droneId;
+        if (busy[droneId] || scanned[droneId]) {
+            continue;
+        }
+        scanned[droneId] = 1;
+        if (it->notBefore > now) {
+            wakeAt = min(wakeAt, it->notBefore);
+            continue;
+        }
+        command = move(*it);
+        queue.erase(it);
+        return true;
+    }
+    return false;
+}
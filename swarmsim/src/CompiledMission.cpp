@@ -0,0 +1,218 @@
+#include "CompiledMission.h"
+#include "SeriesLayout.h"
+#include <ros/console.h>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+using serieslayout::align64;
+using serieslayout::copyComponent;
+
+namespace {
+    const char MAGIC[8] = {'S', 'W', 'A', 'R', 'M', 'B', 'I', 'N'};
+}
+
+CompiledMission::CompiledMission(const string &fPath, bool verify) : file(fPath), header(nullptr),
+                                                                       entries(nullptr) {
+    if (file.size() < sizeof(CompiledMissionHeader)) {
+        throw runtime_error(fPath + " is too small to be a compiled mission");
+    }
+    header = (const CompiledMissionHeader *) file.begin();
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error(fPath + " is not a compiled mission");
+    }
+    if (header->version != VERSION) {
+        throw runtime_error(fPath + " has version " + to_string(header->version) + ", expected "
+                            + to_string(VERSION));
+    }
+    uint64_t nEntries = (uint64_t) header->nDrones * header->nHorizons;
+    if (header->fileSize != file.size()
+        || header->entriesOffset + nEntries * sizeof(CompiledTrajectoryEntry) > file.size()
+        || header->obstaclesOffset + header->nObstacles * sizeof(CompiledObstacle) > file.size()) {
+        throw runtime_error(fPath + " is truncated");
+    }
+    entries = (const CompiledTrajectoryEntry *) (file.begin() + header->entriesOffset);
+    for (uint64_t i = 0; i < nEntries; i++) {
+        if (entries[i].stride < entries[i].nSamples * sizeof(double)
+            || entries[i].stride % sizeof(double) != 0 || entries[i].offset % sizeof(double) != 0
+            || entries[i].offset + NumSeries * entries[i].stride > file.size()) {
+            throw runtime_error(fPath + " has an invalid trajectory entry");
+        }
+    }
+    if (verify && checksum(file.begin() + sizeof(CompiledMissionHeader), file.end()) != header->checksum) {
+        throw runtime_error(fPath + " failed the checksum");
+    }
+    ROS_DEBUG_STREAM("Mapped the compiled mission " << fPath << ": " << header->nDrones << " drones, "
+                                                    << header->nHorizons << " horizons");
+}
+
+int CompiledMission::getDrones() const {
+    return header->nDrones;
+}
+
+int CompiledMission::getHorizons() const {
+    return header->nHorizons;
+}
+
+double CompiledMission::getFrequency() const {
+    return header->frequency;
+}
+
+int CompiledMission::getSamples(int droneId, int horizonId) const {
+    return getEntry(droneId, horizonId).nSamples;
+}
+
+const double *CompiledMission::getSeries(int droneId, int horizonId, int series) const {
+    const CompiledTrajectoryEntry &entry = getEntry(droneId, horizonId);
+    return (const double *) (file.begin() + entry.offset + series * entry.stride);
+}
+
+Trajectory CompiledMission::getTrajectory(int droneId, int horizonId) const {
+    int n = getSamples(droneId, horizonId);
+    const double *series[NumSeries];
+    for (int s = 0; s < NumSeries; s++) {
+        series[s] = getSeries(droneId, horizonId, s);
+    }
+    //the compiled series have the layout of the trajectory, so each one is a single copy
+    Trajectory tr;
+    tr.allocate(n);
+    for (int dim = 0; dim < 3; dim++) {
+        memcpy(tr.pos.data(dim), series[PosX + dim], n * sizeof(double));
+        memcpy(tr.vel.data(dim), series[VelX + dim], n * sizeof(double));
+        memcpy(tr.acc.data(dim), series[AccX + dim], n * sizeof(double));
+    }
+    return tr;
+}
+
+TrajectoryPtr CompiledMission::getTrajectoryView(const shared_ptr<const CompiledMission> &mission, int droneId,
+                                                 int horizonId) {
+    const CompiledTrajectoryEntry &entry = mission->getEntry(droneId, horizonId);
+    //the nine series are stride bytes apart, so every three of them form the blocks of a SampleSeries.
+    //The mapping is read only, the trajectory is only handed out as const
+    size_t capacity = entry.stride / sizeof(double);
+    double *series = const_cast<double *>(mission->getSeries(droneId, horizonId, PosX));
+    Trajectory *tr = new Trajectory();
+    tr->pos.attach(series + PosX * capacity, capacity, entry.nSamples);
+    tr->vel.attach(series + VelX * capacity, capacity, entry.nSamples);
+    tr->acc.attach(series + AccX * capacity, capacity, entry.nSamples);
+    return TrajectoryPtr(tr, [mission](const Trajectory *view) {
+        delete view;
+    });
+}
+
+vector<Obstacle> CompiledMission::getObstacles() const {
+    const CompiledObstacle *obs = (const CompiledObstacle *) (file.begin() + header->obstaclesOffset);
+    vector<Obstacle> obstacles(header->nObstacles);
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        obstacles[i].center = Eigen::Vector3d(obs[i].center[0], obs[i].center[1], obs[i].center[2]);
+        obstacles[i].height = obs[i].height;
+        obstacles[i].width = obs[i].width;
+        obstacles[i].length = obs[i].length;
+    }
+    return obstacles;
+}
+
+const CompiledTrajectoryEntry &CompiledMission::getEntry(int droneId, int horizonId) const {
+    if (droneId < 0 || droneId >= (int) header->nDrones || horizonId < 0 || horizonId >= (int) header->nHorizons) {
+        throw range_error("No compiled trajectory for drone " + to_string(droneId) + " horizon "
+                          + to_string(horizonId));
+    }
+    return entries[(size_t) droneId * header->nHorizons + horizonId];
+}
+
+void CompiledMission::write(const string &fPath, double frequency, const vector<vector<TrajectoryPtr> > &plans,
+                            const vector<Obstacle> &obstacles) {
+    int nHorizons = plans.size();
+    int nDrones = plans.empty() ? 0 : plans[0].size();
+    for (const vector<TrajectoryPtr> &plan : plans) {
+        if ((int) plan.size() != nDrones) {
+            throw runtime_error("Every horizon must have a trajectory for each drone");
+        }
+    }
+
+    uint64_t entriesOffset = align64(sizeof(CompiledMissionHeader));
+    uint64_t obstaclesOffset = align64(entriesOffset + (uint64_t) nDrones * nHorizons * sizeof(CompiledTrajectoryEntry));
+    uint64_t dataOffset = align64(obstaclesOffset + obstacles.size() * sizeof(CompiledObstacle));
+    vector<CompiledTrajectoryEntry> entryList((size_t) nDrones * nHorizons);
+    for (int k = 0; k < nDrones; k++) {
+        for (int h = 0; h < nHorizons; h++) {
+            CompiledTrajectoryEntry &entry = entryList[(size_t) k * nHorizons + h];
+            entry.nSamples = plans[h][k]->pos.size();
+            entry.stride = align64(entry.nSamples * sizeof(double));
+            entry.offset = dataOffset;
+            entry.reserved = 0;
+            dataOffset += NumSeries * entry.stride;
+        }
+    }
+
+    vector<char> buf(dataOffset, 0);
+    memcpy(&buf[entriesOffset], entryList.data(), entryList.size() * sizeof(CompiledTrajectoryEntry));
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        CompiledObstacle ob;
+        for (int dim = 0; dim < 3; dim++) {
+            ob.center[dim] = obstacles[i].center[dim];
+        }
+        ob.height = obstacles[i].height;
+        ob.width = obstacles[i].width;
+        ob.length = obstacles[i].length;
+        memcpy(&buf[obstaclesOffset + i * sizeof(CompiledObstacle)], &ob, sizeof(ob));
+    }
+    for (int k = 0; k < nDrones; k++) {
+        for (int h = 0; h < nHorizons; h++) {
+            const CompiledTrajectoryEntry &entry = entryList[(size_t) k * nHorizons + h];
+            const Trajectory &tr = *plans[h][k];
+            for (int dim = 0; dim < 3; dim++) {
+                copyComponent(tr.pos, dim, entry.nSamples, (double *) &buf[entry.offset + (PosX + dim) * entry.stride]);
+                copyComponent(tr.vel, dim, entry.nSamples, (double *) &buf[entry.offset + (VelX + dim) * entry.stride]);
+                copyComponent(tr.acc, dim, entry.nSamples, (double *) &buf[entry.offset + (AccX + dim) * entry.stride]);
+            }
+        }
+    }
+
+    CompiledMissionHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.nDrones = nDrones;
+    header.nHorizons = nHorizons;
+    header.nObstacles = obstacles.size();
+    header.frequency = frequency;
+    header.entriesOffset = entriesOffset;
+    header.obstaclesOffset = obstaclesOffset;
+    header.fileSize = buf.size();
+    header.checksum = checksum(buf.data() + sizeof(header), buf.data() + buf.size());
+    memcpy(buf.data(), &header, sizeof(header));
+
+    string tmpPath = fPath + ".tmp";
+    {
+        ofstream out(tmpPath.c_str(), ios::out | ios::binary | ios::trunc);
+        out.write(buf.data(), buf.size());
+        if (!out) {
+            throw runtime_error("Failed to write " + tmpPath);
+        }
+    }
+    if (rename(tmpPath.c_str(), fPath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        throw runtime_error("Failed to replace " + fPath);
+    }
+}
+
+uint64_t CompiledMission::checksum(const char *begin, const char *end) {
+    //FNV-1a folded a word at a time, the blocks are 64 byte aligned so the tail is rarely used
+    uint64_t hash = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+    const char *p = begin;
+    for (; end - p >= 8; p += 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        hash ^= word;
+        hash *= prime;
+    }
+    for (; p < end; p++) {
+        hash ^= (unsigned char) *p;
+        hash *= prime;
+    }
+    return hash;
+}
@@ -0,0 +1,91 @@
+#include "CpuUsage.h"
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+CpuUsage::CpuUsage(vector<string> processes) : processes(move(processes)) {
+    lastCpu = readCpu();
+    lastWall = chrono::steady_clock::now();
+}
+
+double CpuUsage::sample() {
+    map<int, double> cpu = readCpu();
+    chrono::steady_clock::time_point wall = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double>(wall - lastWall).count();
+    double used = 0;
+    for (const pair<const int, double> &process : cpu) {
+        //a process started since the previous sample counts from its start
+        auto last = lastCpu.find(process.first);
+        used += process.second - (last == lastCpu.end() ? 0 : last->second);
+    }
+    lastCpu = move(cpu);
+    lastWall = wall;
+    return elapsed > 0 ? used / elapsed : 0;
+}
+
+int CpuUsage::getProcesses() const {
+    return lastCpu.size();
+}
+
+map<int, double> CpuUsage::readCpu() const {
+    map<int, double> cpu;
+    int self = getpid();
+    double own = processCpu(self);
+    if (own >= 0) {
+        cpu[self] = own;
+    }
+    if (processes.empty()) {
+        return cpu;
+    }
+    DIR *proc = opendir("/proc");
+    if (proc == nullptr) {
+        return cpu;
+    }
+    while (dirent *entry = readdir(proc)) {
+        int pid = atoi(entry->d_name);
+        if (pid <= 0 || pid == self
+            || find(processes.begin(), processes.end(), processName(pid)) == processes.end()) {
+            continue;
+        }
+        double used = processCpu(pid);
+        if (used >= 0) {
+            cpu[pid] = used;
+        }
+    }
+    closedir(proc);
+    return cpu;
+}
+
+double CpuUsage::processCpu(int pid) {
+    ifstream in("/proc/" + to_string(pid) + "/stat");
+    string stat;
+    if (!getline(in, stat)) {
+        return -1;
+    }
+    //the name in parentheses may hold spaces, the fields after it do not
+    size_t end = stat.rfind(')');
+    if (end == string::npos) {
+        return -1;
+    }
+    istringstream fields(stat.substr(end + 1));
+    string skipped;
+    //utime and stime are the 14th and 15th fields, the state is the 3rd
+    for (int field = 3; field < 14; field++) {
+        fields >> skipped;
+    }
+    double utime, stime;
+    if (!(fields >> utime >> stime)) {
+        return -1;
+    }
+    return (utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+string CpuUsage::processName(int pid) {
+    ifstream in("/proc/" + to_string(pid) + "/cmdline");
+    string argv0;
+    getline(in, argv0, '\0');
+    return argv0.substr(argv0.rfind('/') + 1);
+}
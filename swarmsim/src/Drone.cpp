@@ -2,17 +2,71 @@
 #include "mavros_msgs/CommandBool.h"
 #include "mavros_msgs/CommandTOL.h"
 #include "mavros_msgs/SetMode.h"
+#include "std_msgs/Float64MultiArray.h"
 #include "ros/console.h"
+#include <boost/make_shared.hpp>
 
 using namespace std;
 
-Drone::Drone(int id, const ros::NodeHandle &n) : id(id), nh(n) {
+namespace {
+    bool accepted(const mavros_msgs::CommandBool &srv) {
+        return srv.response.success;
+    }
+
+    bool accepted(const mavros_msgs::CommandTOL &srv) {
+        return srv.response.success;
+    }
+
+    bool accepted(const mavros_msgs::SetMode &srv) {
+        return srv.response.mode_sent;
+    }
+
+    /**
+     * The blocking part of a command, run by a dispatcher worker. client is the persistent
+     * client of the drone, so no new connection is set up per call. The dispatcher runs the
+     * commands of a drone one at a time, so only one worker uses its clients at once.
+     */
+    template<typename S>
+    function<bool()> makeCall(ros::NodeHandle nh, ros::ServiceClient *client, S srv) {
+        return [nh, client, srv]() mutable {
+            if (!client->waitForExistence(ros::Duration(5))) {
+                return false;
+            }
+            if (client->call(srv)) {
+                return accepted(srv);
+            }
+            //a persistent client stays broken once its connection drops, e.g. when mavros
+            //restarts, so the retry of the dispatcher gets a new one
+            if (!client->isValid()) {
+                ROS_WARN_STREAM("Reconnecting to " << client->getService());
+                *client = nh.serviceClient<S>(client->getService(), true);
+            }
+            return false;
+        };
+    }
+
+    string getServiceName(int id, const string &service) {
+        stringstream ss;
+        ss << "/" << id << "/mavros/" << service;
+        return ss.str();
+    }
+}
+
+Drone::Drone(int id, const ros::NodeHandle &n, CommandDispatcher *dispatcher, ros::CallbackQueue *callbacks,
+             StateCounters *counters)
+        : id(id), state(-1), counters(counters), nh(n), dispatcher(dispatcher) {
     ROS_DEBUG_STREAM("Initializing drone " << id);
+    if (callbacks != nullptr) {
+        nh.setCallbackQueue(callbacks);
+    }
     setState(States::Idle);
     setReady = false;
     takeoffHeight = 2.5;
-    execPointer = 0;
-    trajectoryId = 0;
+    recorder = nullptr;
+    segmentTolerance = 0.01;
+    sentTrajectoryId = -1;
+    resumed = false;
+    homeRecorded = false;
     std::string globalPositionTopic = getPositionTopic("global");
     std::string localPositionTopic = getPositionTopic("local");
     std::string poseTopic = getPoseTopic();
@@ -26,18 +80,61 @@ Drone::Drone(int id, const ros::NodeHandle &n) : id(id), nh(n) {
     std::string positionSetPointTopic = getLocalSetpointTopic("position");
     posSetPointPub =
             nh.advertise<geometry_msgs::PoseStamped>(positionSetPointTopic, 10);
+    rawSetPointPub = nh.advertise<mavros_msgs::PositionTarget>(getLocalSetpointTopic("raw"), 10);
+    std::stringstream ss_segments;
+    ss_segments << "/" << id << "/swarm/segments";
+    segmentsPub = nh.advertise<std_msgs::Float64MultiArray>(ss_segments.str(), 10);
     mavrosStateSub = nh.subscribe(mavrosStateTopic,10, &Drone::mavrosStateCB, this);
-    gazeboStateSub = nh.subscribe("/gazebo/model_states", 10, &Drone::gazeboStateCB, this);
     // poseSub = nh.subscribe(this->getPoseTopic(), 10, &Drone::poseCB, this);
-    ros::topic::waitForMessage<gazebo_msgs::ModelStates>("/gazebo/model_states", ros::Duration(5));
     std::stringstream ss_global;
     ss_global << "global_pose/" << id;
     std::string globalPoseTopic = ss_global.str();
     globalPosePub = nh.advertise<geometry_msgs::PoseStamped>(globalPoseTopic, 10);
+    armingClient = nh.serviceClient<mavros_msgs::CommandBool>(getServiceName(id, "cmd/arming"), true);
+    takeoffClient = nh.serviceClient<mavros_msgs::CommandTOL>(getServiceName(id, "cmd/takeoff"), true);
+    landClient = nh.serviceClient<mavros_msgs::CommandTOL>(getServiceName(id, "cmd/land"), true);
+    setModeClient = nh.serviceClient<mavros_msgs::SetMode>(getServiceName(id, "set_mode"), true);
+}
+
+void Drone::setFeedforward(bool feedforward) {
+    tick.feedforward = feedforward;
+}
+
+void Drone::setSegmentExecution(bool segments, double tolerance) {
+    tick.segmentExecution = segments;
+    segmentTolerance = tolerance;
+}
+
+TrackingStats Drone::getTrackingStats() {
+    lock_guard<mutex> lock(trajectoryMutex);
+    return tracking;
+}
+
+void Drone::setRecorder(FlightRecorder *recorder) {
+    this->recorder = recorder;
+}
+
+DroneCheckpoint Drone::getCheckpoint() {
+    lock_guard<mutex> lock(trajectoryMutex);
+    DroneCheckpoint checkpoint;
+    checkpoint.home = initGazeboPos;
+    queue.getCheckpoint(checkpoint);
+    return checkpoint;
+}
+
+void Drone::restore(const DroneCheckpoint &checkpoint) {
+    lock_guard<mutex> lock(trajectoryMutex);
+    queue.restore(checkpoint);
+    sentTrajectoryId = -1;
+    initGazeboPos = checkpoint.home;
+    resumed = true;
+    homeRecorded = true;
+    ROS_DEBUG_STREAM("Drone: " << id << " resumed trajectory " << queue.getTrajectoryId() << " at "
+                               << queue.getExecPointer());
 }
 
 void Drone::publishGlobalPose() {
-    globalPosePub.publish(this->pose_global);
+    globalPosePub.publish(boost::make_shared<geometry_msgs::PoseStamped>(this->pose_global));
 }
 
 int Drone::getState() { return state; }
@@ -49,56 +146,71 @@ void Drone::mavrosStateCB(const mavros_msgs::StateConstPtr& msg) {
         ready(true);
         setReady = true;
         this->mavrosStateSub.shutdown();
+        LocalPoseSample local;
+        GlobalFixSample global;
+        localPoseSlot.load(local);
+        globalFixSlot.load(global);
         ROS_DEBUG_STREAM("Drone: " << id << " Init position local: "
-                            << curr_pos_local[0] << " " << curr_pos_local[1]
-                            << " " << curr_pos_local[2]);
+                            << local.position[0] << " " << local.position[1]
+                            << " " << local.position[2]);
         ROS_DEBUG_STREAM("Drone: "
-                            << id << " Init position global: " << curr_pos_global[0]
-                            << " " << curr_pos_global[1] << " " << curr_pos_global[2]);
+                            << id << " Init position global: " << global.position[0]
+                            << " " << global.position[1] << " " << global.position[2]);
     }
 }
 
-void Drone::gazeboStateCB(const gazebo_msgs::ModelStatesConstPtr& msg) {
-    if(this->state == States::Armed) {
-        ros::V_string gazeboElementsArray = msg->name;
-        stringstream drone_ss;
-        drone_ss << "iris_"<<this->id;
-        string drone_str = drone_ss.str();
-        for(int i=0;i<gazeboElementsArray.size();i++) {
-            string key = gazeboElementsArray[i];
-            if(drone_str.compare(key) == 0) {
-                this->gazeboElementIdx = i;
-                geometry_msgs::Pose robot_pose = msg->pose[gazeboElementIdx];
-                initGazeboPos << robot_pose.position.x, robot_pose.position.y, robot_pose.position.z;
-                ROS_DEBUG_STREAM("Init gazebo pose recorded: "<<initGazeboPos[0]<<" "
-                <<initGazeboPos[1]<<" "<<initGazeboPos[2]);
-                gazeboStateSub.shutdown();
-            }
-        }
+void Drone::setGazeboPose(const geometry_msgs::Pose &robot_pose) {
+    if (this->state == States::Armed && !homeRecorded) {
+        initGazeboPos << robot_pose.position.x, robot_pose.position.y, robot_pose.position.z;
+        ROS_DEBUG_STREAM("Drone: " << id << " Init gazebo pose recorded: " << initGazeboPos[0] << " "
+                                   << initGazeboPos[1] << " " << initGazeboPos[2]);
+        homeRecorded = true;
     }
 }
 
-void Drone::positionLocalCB(const nav_msgs::Odometry::ConstPtr &msg) {
-    geometry_msgs::Point pos = msg->pose.pose.position;
-    curr_pos_local << pos.x, pos.y, pos.z;
-    yaw = getRPY(msg->pose.pose.orientation)[2];
-
-    Eigen::Vector3d currentPos_global;  
-    currentPos_global = curr_pos_local + initGazeboPos;
-    geometry_msgs::Point globalPt;
-    globalPt.x = currentPos_global[0];
-    globalPt.y = currentPos_global[1];
-    globalPt.z = currentPos_global[2];
+bool Drone::hasHome() {
+    return homeRecorded;
+}
 
-    this->pose_global.pose.position = globalPt;
-    this->pose_global.pose.orientation = msg->pose.pose.orientation;
-    this->pose_global.header.frame_id = "map";
+void Drone::positionLocalCB(const nav_msgs::Odometry::ConstPtr &msg) {
+    const geometry_msgs::Point &pos = msg->pose.pose.position;
+    const geometry_msgs::Quaternion &q = msg->pose.pose.orientation;
+    LocalPoseSample sample = {{pos.x, pos.y, pos.z}, {q.x, q.y, q.z, q.w}};
+    localPoseSlot.store(sample);
+    if (recorder != nullptr) {
+        recorder->recordPose(msg->header.stamp.toSec(), id, Vector3d(pos.x, pos.y, pos.z));
+    }
 }
 
 void Drone::positionGlobalCB(const sensor_msgs::NavSatFixConstPtr &msg) {
-    curr_pos_global << msg->latitude, msg->longitude, msg->altitude;
-    if(this->state == States::Armed) {
-        init_pos_global = curr_pos_global;
+    GlobalFixSample sample = {{msg->latitude, msg->longitude, msg->altitude}};
+    globalFixSlot.store(sample);
+}
+
+void Drone::updatePose() {
+    LocalPoseSample local;
+    if (localPoseSlot.load(local)) {
+        curr_pos_local << local.position[0], local.position[1], local.position[2];
+        geometry_msgs::Quaternion q;
+        q.x = local.orientation[0];
+        q.y = local.orientation[1];
+        q.z = local.orientation[2];
+        q.w = local.orientation[3];
+        yaw = getRPY(q)[2];
+
+        Eigen::Vector3d currentPos_global = curr_pos_local + initGazeboPos;
+        this->pose_global.pose.position.x = currentPos_global[0];
+        this->pose_global.pose.position.y = currentPos_global[1];
+        this->pose_global.pose.position.z = currentPos_global[2];
+        this->pose_global.pose.orientation = q;
+        this->pose_global.header.frame_id = "map";
+    }
+    GlobalFixSample global;
+    if (globalFixSlot.load(global)) {
+        curr_pos_global << global.position[0], global.position[1], global.position[2];
+        if (this->state == States::Armed) {
+            init_pos_global = curr_pos_global;
+        }
     }
 }
 
@@ -109,32 +221,51 @@ void Drone::positionGlobalCB(const sensor_msgs::NavSatFixConstPtr &msg) {
 // }
 
 void Drone::arm(bool arm) {
-    stringstream ss_arm;
-    ss_arm << "/" << id << "/mavros/cmd/arming";
-    string arm_service = ss_arm.str();
-    ros::ServiceClient arming_cl =
-            nh.serviceClient<mavros_msgs::CommandBool>(arm_service);
+    if (!arm || state != States::Ready) {
+        return;
+    }
+    switch (dispatcher->getStatus(id, ArmCommand)) {
+        case CommandPending:
+            return;
+        case CommandSucceeded:
+            ROS_DEBUG_STREAM("Drone: " << id << " armed");
+            dispatcher->reset(id, ArmCommand);
+            setState(States::Armed);
+            return;
+        case CommandFailed:
+            ROS_ERROR_STREAM("Arm request failed for drone: " << id << ". Trying again");
+            dispatcher->reset(id, ArmCommand);
+            break;
+        default:
+            break;
+    }
     mavros_msgs::CommandBool srv;
     srv.request.value = arm;
-    ROS_DEBUG_STREAM("Waiting for arm service " << arm_service);
-    arming_cl.waitForExistence();
-    if (arming_cl.call(srv)) {
-        ROS_DEBUG_STREAM("Arm request sent");
-    } else {
-        ROS_ERROR_STREAM("Arm request failed for drone: " << id);
-    }
-    arm ? state = States::Armed : States::Ready;
+    dispatcher->dispatch(id, ArmCommand, makeCall(nh, &armingClient, srv));
 }
 
 void Drone::TOLService(bool takeoff) {
     if (state == States::Armed && takeoff) {
-        callTOLService(true);
+        if (!resumed || curr_pos_local[2] < takeoffHeight - 0.2) {
+            callTOLService(true);
+        }
         setState(States::Takingoff);
     } else if (state == States::Takingoff) {
+        if (dispatcher->getStatus(id, TakeoffCommand) == CommandFailed) {
+            dispatcher->reset(id, TakeoffCommand);
+            callTOLService(true);
+        }
         if (curr_pos_local[2] >= takeoffHeight - 0.2) {
             setState(States::Autonomous);
             setMode("OFFBOARD");
         }
+    } else if (state == States::Autonomous && takeoff) {
+        lock_guard<mutex> lock(modeMutex);
+        if (dispatcher->getStatus(id, SetModeCommand) == CommandFailed) {
+            ROS_ERROR_STREAM("Mode request failed for drone: " << id << ". Trying again");
+            dispatcher->reset(id, SetModeCommand);
+            dispatchMode();
+        }
     } else if (state == States::Reached && !takeoff) {
         callTOLService(false);
         setState(States::Idle);
@@ -142,13 +273,6 @@ void Drone::TOLService(bool takeoff) {
 }
 
 void Drone::callTOLService(bool takeoff) {
-    std::string serviceId;
-    takeoff ? serviceId = "takeoff" : serviceId = "land";
-    stringstream ss_to;
-    ss_to << "/" << id << "/mavros/cmd/" << serviceId;
-    string to_service = ss_to.str();
-    ros::ServiceClient to_cl =
-            nh.serviceClient<mavros_msgs::CommandTOL>(to_service);
     mavros_msgs::CommandTOL srv_takeoff;
 
     if (takeoff) {
@@ -168,25 +292,14 @@ void Drone::callTOLService(bool takeoff) {
 
     srv_takeoff.request.min_pitch = 0;
     srv_takeoff.request.yaw = M_PI / 2;
-    ROS_DEBUG_STREAM("Waiting for TOL service " << to_service);
-    to_cl.waitForExistence();
-    if (to_cl.call(srv_takeoff)) {
-        ROS_DEBUG_STREAM("TOL request sent" << to_service);
+    if (takeoff) {
+        dispatcher->dispatch(id, TakeoffCommand, makeCall(nh, &takeoffClient, srv_takeoff));
     } else {
-        ROS_ERROR_STREAM("TOL request failed " << to_service);
+        dispatcher->dispatch(id, LandCommand, makeCall(nh, &landClient, srv_takeoff));
     }
 }
 
 void Drone::setMode(std::string mode) {
-    stringstream ss_prefix;
-    ss_prefix << "/" << id << "/mavros/set_mode";
-    string smService = ss_prefix.str();
-    ros::ServiceClient smClient =
-            nh.serviceClient<mavros_msgs::SetMode>(smService);
-    mavros_msgs::SetMode setMode;
-    setMode.request.custom_mode = mode;
-    smClient.waitForExistence();
-
     // need to have some setpoints already in the queue to change to OFFBOARD mode
     if (mode.compare("OFFBOARD") == 0) {
         ROS_DEBUG_STREAM(
@@ -200,67 +313,135 @@ void Drone::setMode(std::string mode) {
         }
     }
 
-    if (smClient.call(setMode)) {
-        ROS_DEBUG_STREAM("Set mode request sent " << mode << " " << smService);
-    } else {
-        ROS_DEBUG_STREAM("Set mode failed " << smService);
-    }
+    lock_guard<mutex> lock(modeMutex);
+    requestedMode = move(mode);
+    dispatchMode();
 }
 
-void Drone::sendPositionSetPoint(geometry_msgs::PoseStamped setPoint) {
+void Drone::dispatchMode() {
+    mavros_msgs::SetMode setMode;
+    setMode.request.custom_mode = requestedMode;
+    ROS_DEBUG_STREAM("Drone: " << id << " requesting mode " << requestedMode);
+    dispatcher->dispatch(id, SetModeCommand, makeCall(nh, &setModeClient, setMode));
+}
+
+void Drone::sendPositionSetPoint(const geometry_msgs::PoseStamped &setPoint) {
     if (state == States::Autonomous) {
         posSetPointPub.publish(setPoint);
     }
 }
 
-Vector3d Drone::getLocalWaypoint(Vector3d waypoint) {
-    return waypoint - initGazeboPos;
+void Drone::sendPositionTarget(const mavros_msgs::PositionTarget &target) {
+    if (state == States::Autonomous) {
+        rawSetPointPub.publish(target);
+    }
+}
+
+void Drone::sendSegments(double sampleRate) {
+    //every queued horizon starts where the one before it ends
+    double start = queue.getStart();
+    int trajectoryId = queue.getTrajectoryId();
+    for (int i = 0; i < (int) queue.size(); i++) {
+        const Trajectory &tr = *queue.get(i);
+        if (trajectoryId + i > sentTrajectoryId) {
+            SegmentedTrajectory segmented = SegmentedTrajectory::fit(tr, sampleRate, segmentTolerance, -initGazeboPos);
+            segmented.trajectoryId = trajectoryId + i;
+            segmented.start = start;
+            //published by pointer, an executor loaded into the same nodelet manager gets it without serialization
+            std_msgs::Float64MultiArrayPtr msg = boost::make_shared<std_msgs::Float64MultiArray>();
+            segmented.encode(msg->data);
+            segmentsPub.publish(msg);
+            sentTrajectoryId = segmented.trajectoryId;
+            ROS_DEBUG_STREAM("Drone: " << id << " sent horizon " << sentTrajectoryId << " as "
+                                       << segmented.segments.size() << " segments");
+        }
+        start += (tr.pos.size() - 1) / sampleRate;
+    }
+}
+
+void Drone::updateTracking(const Vector3d &waypoint) {
+    //read the slot directly, curr_pos_local belongs to the supervisory thread
+    LocalPoseSample local;
+    if (!localPoseSlot.load(local)) {
+        return;
+    }
+    tracking.add(Vector3d(local.position[0], local.position[1], local.position[2]) - waypoint);
 }
 
-void Drone::setTrajectory(Trajectory trajectory) {
-    execPointer = 0;
-    this->trajectory = trajectory;
+Vector3d Drone::getLocalWaypoint(Vector3d waypoint) {
+    return waypoint - initGazeboPos;
 }
 
-int Drone::executeTrajectory() {
+int Drone::executeTrajectory(double now, double sampleRate) {
+    lock_guard<mutex> lock(trajectoryMutex);
     if (state == States::Autonomous) {
-        Vector3d waypoint_temp, waypoint;
-        //notReachedEnd
-        if (execPointer < trajectory.pos.size() - 1) {
-            waypoint_temp = trajectory.pos[execPointer++];
-            waypoint = getLocalWaypoint(waypoint_temp);
-        }
-            //reachedEnd and moreTrajectoriesAvailable
-        else if ((trajectoryId < TrajectoryList.size() - 1) && (execPointer == trajectory.pos.size() - 1)) {
-            ROS_DEBUG_STREAM("Setting next trajectory for drone: " << this->id);
-            Trajectory nextTraj = TrajectoryList[++trajectoryId];
-            setTrajectory(nextTraj);
-            waypoint = trajectory.pos[execPointer];
-            ROS_DEBUG_STREAM("set next wpts for drone: " << id << " " << waypoint[0] << " " << waypoint[1] << " "
-                                                         << waypoint[2]);
-        }
-            //reachedEnd and noMoreTrajectories
-        else {
+        //reachedEnd and noMoreTrajectories
+        if (!tick.update(queue, now, sampleRate, initGazeboPos, ros::Time::now())) {
             ROS_DEBUG_STREAM("No more trajectories. Setting state as Reached");
             setMode("AUTO.LOITER");
             setState(States::Reached);
-            waypoint = trajectory.pos[execPointer - 1];
         }
-        geometry_msgs::PoseStamped setpoint;
-        setpoint.pose.position.x = waypoint[0];
-        setpoint.pose.position.y = waypoint[1];
-        setpoint.pose.position.z = waypoint[2];
-        sendPositionSetPoint(setpoint);
+        const Vector3d &waypoint = tick.waypoint;
+        //the messages of tick are reused, so filling them does not allocate. roscpp still
+        //serializes every publish into a buffer of its own
+        if (tick.segmentExecution) {
+            sendSegments(sampleRate);
+        } else if (tick.feedforward) {
+            sendPositionTarget(tick.targetMsg);
+        } else {
+            sendPositionSetPoint(tick.setpointMsg);
+        }
+        updateTracking(waypoint);
+        if (recorder != nullptr) {
+            recorder->recordSetpoint(ros::Time::now().toSec(), id, waypoint, queue.getExecPointer());
+        }
     }
-    return execPointer;
+    return queue.getExecPointer();
+}
+
+void Drone::pushTrajectory(TrajectoryPtr trajectory) {
+    lock_guard<mutex> lock(trajectoryMutex);
+    queue.push(move(trajectory));
+}
+
+bool Drone::getSplicePoint(int ticksAhead, int &spliceIdx, TrajectoryState &state, int &trajectoryId_) {
+    lock_guard<mutex> lock(trajectoryMutex);
+    trajectoryId_ = queue.getTrajectoryId();
+    return queue.getSplicePoint(ticksAhead, spliceIdx, state);
 }
 
-void Drone::pushTrajectory(Trajectory trajectory) {
-    TrajectoryList.push_back(trajectory);
-    //setting the initial trajectory
-    if (TrajectoryList.size() == 1) {
-        setTrajectory(TrajectoryList[trajectoryId]);
+TrajectoryState Drone::getEndState() {
+    lock_guard<mutex> lock(trajectoryMutex);
+    const Trajectory &trajectory = *queue.getCurrent();
+    return trajectory.getState(trajectory.pos.size() - 1);
+}
+
+Vector3d Drone::getExpectedEndPosition() {
+    lock_guard<mutex> lock(trajectoryMutex);
+    const Trajectory &last = *queue.getLast();
+    return last.pos[last.pos.size() - 1] + tracking.last;
+}
+
+bool Drone::spliceTrajectory(const Trajectory &splice, int trajectoryId_, int spliceIdx) {
+    lock_guard<mutex> lock(trajectoryMutex);
+    if (!queue.splice(splice, trajectoryId_, spliceIdx)) {
+        ROS_WARN_STREAM("Drone: " << id << " passed the splice point " << spliceIdx << ". Splice rejected");
+        return false;
     }
+    //the splice moves the start of the queued horizons as well, the executor gets them all again
+    sentTrajectoryId = trajectoryId_ - 1;
+    ROS_DEBUG_STREAM("Drone: " << id << " spliced a new trajectory at " << spliceIdx);
+    return true;
+}
+
+int Drone::getTrajectorySize() {
+    lock_guard<mutex> lock(trajectoryMutex);
+    return queue.getCurrent()->pos.size();
+}
+
+int Drone::getTrajectoryId() {
+    lock_guard<mutex> lock(trajectoryMutex);
+    return queue.getTrajectoryId();
 }
 
 std::string Drone::getPositionTopic(std::string locale) {
@@ -286,7 +467,11 @@ Vector3d Drone::getRPY(geometry_msgs::Quaternion orientation) {
 }
 
 void Drone::setState(int state) {
-    this->state = state;
+    //exchange hands every previous state to exactly one transition, whichever thread makes it
+    int previous = this->state.exchange(state);
+    if (counters != nullptr) {
+        counters->transition(previous, state);
+    }
     ROS_DEBUG_STREAM("Drone: " << id << " Set drone state " << state);
 }
 
@@ -320,6 +505,8 @@ std::string Drone::getLocalSetpointTopic(std::string order) {
         postfix = "cmd_vel";
     } else if (order.compare("accel") == 0) {
         postfix = "accel";
+    } else if (order.compare("raw") == 0) {
+        postfix = "local";
     }
     ss_prefix << "/" << this->id << "/mavros/setpoint_" << order << "/" << postfix;
     return ss_prefix.str();
@@ -0,0 +1,134 @@
+#include "FlightRecorder.h"
+#include "MemoryAccounting.h"
+#include <ros/console.h>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[8] = {'S', 'W', 'A', 'R', 'M', 'L', 'O', 'G'};
+
+    FlightRecord makeRecord(double stamp, RecordType type, int droneId, int value) {
+        FlightRecord r;
+        memset(&r, 0, sizeof(r));
+        r.stamp = stamp;
+        r.type = type;
+        r.droneId = droneId;
+        r.value = value;
+        return r;
+    }
+}
+
+FlightRecorder::FlightRecorder(const string &fPath, size_t capacity)
+        : queue(capacity), out(fPath.c_str(), ios::out | ios::binary | ios::trunc), stopped(false), dropped(0) {
+    if (!out) {
+        throw runtime_error("Failed to create the flight log " + fPath);
+    }
+    FlightLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(FlightRecord);
+    out.write((const char *) &header, sizeof(header));
+    writer = thread(&FlightRecorder::writeLoop, this);
+    MemoryAccounting::allocated(RecorderMemory, queue.capacity() * sizeof(FlightRecord));
+    ROS_DEBUG_STREAM("Recording the flight to " << fPath);
+}
+
+FlightRecorder::~FlightRecorder() {
+    stopped = true;
+    writer.join();
+    MemoryAccounting::released(RecorderMemory, queue.capacity() * sizeof(FlightRecord));
+    if (dropped > 0) {
+        ROS_WARN_STREAM("Flight recorder dropped " << dropped << " records");
+    }
+}
+
+void FlightRecorder::recordState(double stamp, int state) {
+    record(makeRecord(stamp, SwarmStateRecord, -1, state));
+}
+
+void FlightRecorder::recordSetpoint(double stamp, int droneId, const Eigen::Vector3d &pos, int execPointer) {
+    FlightRecord r = makeRecord(stamp, SetpointRecord, droneId, execPointer);
+    r.x = pos[0];
+    r.y = pos[1];
+    r.z = pos[2];
+    record(r);
+}
+
+void FlightRecorder::recordPose(double stamp, int droneId, const Eigen::Vector3d &pos) {
+    FlightRecord r = makeRecord(stamp, PoseRecord, droneId, 0);
+    r.x = pos[0];
+    r.y = pos[1];
+    r.z = pos[2];
+    record(r);
+}
+
+void FlightRecorder::recordPlanningEvent(double stamp, PlanningEvent event, int horizonId) {
+    FlightRecord r = makeRecord(stamp, PlanningRecord, -1, horizonId);
+    r.event = event;
+    record(r);
+}
+
+void FlightRecorder::record(const FlightRecord &r) {
+    if (!queue.push(r)) {
+        dropped.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+uint64_t FlightRecorder::getDropped() const {
+    return dropped;
+}
+
+void FlightRecorder::writeLoop() {
+    vector<FlightRecord> batch(4096);
+    auto lastFlush = chrono::steady_clock::now();
+    for (;;) {
+        //read the flag before draining so nothing pushed before the stop is lost
+        bool stopping = stopped;
+        size_t n = 0;
+        while (n < batch.size() && queue.pop(batch[n])) {
+            n++;
+        }
+        if (n > 0) {
+            out.write((const char *) batch.data(), n * sizeof(FlightRecord));
+        }
+        auto now = chrono::steady_clock::now();
+        if (now - lastFlush > chrono::seconds(1)) {
+            //bounds what is lost if the node dies
+            out.flush();
+            lastFlush = now;
+        }
+        if (n == batch.size()) {
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    out.flush();
+}
+
+vector<FlightRecord> FlightRecorder::readLog(const string &fPath) {
+    ifstream in(fPath.c_str(), ios::in | ios::binary);
+    if (!in) {
+        throw runtime_error("Failed to open the flight log " + fPath);
+    }
+    FlightLogHeader header;
+    in.read((char *) &header, sizeof(header));
+    if (!in || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error(fPath + " is not a flight log");
+    }
+    if (header.version != VERSION || header.recordSize != sizeof(FlightRecord)) {
+        throw runtime_error(fPath + " has version " + to_string(header.version) + ", expected "
+                            + to_string(VERSION));
+    }
+    in.seekg(0, ios::end);
+    size_t n = ((size_t) in.tellg() - sizeof(header)) / sizeof(FlightRecord);
+    in.seekg(sizeof(header), ios::beg);
+    //a log cut off mid record by a crash keeps its complete records
+    vector<FlightRecord> records(n);
+    in.read((char *) records.data(), n * sizeof(FlightRecord));
+    return records;
+}
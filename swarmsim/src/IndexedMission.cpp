@@ -0,0 +1,164 @@
+#include "IndexedMission.h"
+#include "MissionParser.h"
+#include <ros/console.h>
+#include <algorithm>
+#include <stdexcept>
+
+IndexedMission::IndexedMission(const string &fPath, int window)
+        : file(fPath), window(max(window, 0)), nDrones(0), nHorizons(0), nSubgoals(0), movingThreshold(0),
+          hoveringThreshold(0) {
+    buildIndex();
+    ROS_DEBUG_STREAM("Indexed " << nDrones << " drones and " << nHorizons << " horizons of " << fPath);
+}
+
+void IndexedMission::buildIndex() {
+    int nHorizonsHeader = -1;
+    int currDrone = -1;
+    bool inHorizon = false;
+    vector<vector<size_t> > droneOffsets;
+
+    const char *cur = file.begin();
+    int lineNo = 0;
+    MissionParser::Line line;
+    vector<double> values;
+    int idx;
+    while (MissionParser::nextLine(cur, file.end(), lineNo, line)) {
+        //subgoals are only stored when their horizon is requested, but checked here
+        if (MissionParser::keyEquals(line, "subgoal")) {
+            if (!inHorizon) {
+                MissionParser::fail(line, "subgoal outside of a drone horizon");
+            }
+            values.clear();
+            MissionParser::parseNumbers(line, values);
+            if (values.size() != 3) {
+                MissionParser::fail(line, "expected a subgoal of three coordinates");
+            }
+            continue;
+        }
+        inHorizon = false;
+        if (currDrone >= 0 && MissionParser::parseIndexedKey(line, "horizon", idx)) {
+            vector<size_t> &horizons = droneOffsets[currDrone];
+            if ((int) horizons.size() <= idx) {
+                horizons.resize(idx + 1, string::npos);
+            }
+            horizons[idx] = cur - file.begin();
+            inHorizon = true;
+        } else if (MissionParser::parseIndexedKey(line, "drone", idx)) {
+            currDrone = idx;
+            if ((int) droneOffsets.size() <= idx) {
+                droneOffsets.resize(idx + 1);
+            }
+        } else if (MissionParser::parseIndexedKey(line, "timeset", idx)) {
+            if ((int) timesArray.size() <= idx) {
+                timesArray.resize(idx + 1);
+            }
+            timesArray[idx].times.clear();
+            MissionParser::parseNumbers(line, timesArray[idx].times);
+        } else if (MissionParser::keyEquals(line, "times")) {
+            currDrone = -1;
+        } else if (MissionParser::keyEquals(line, "horizons")) {
+            nHorizonsHeader = (int) MissionParser::parseNumber(line);
+        } else if (MissionParser::keyEquals(line, "subgoals")) {
+            nSubgoals = (int) MissionParser::parseNumber(line);
+        } else if (MissionParser::keyEquals(line, "movingThreshold")) {
+            movingThreshold = MissionParser::parseNumber(line);
+        } else if (MissionParser::keyEquals(line, "hoveringThreshold")) {
+            hoveringThreshold = MissionParser::parseNumber(line);
+        }
+    }
+
+    nDrones = droneOffsets.size();
+    nHorizons = nHorizonsHeader >= 0 ? nHorizonsHeader : timesArray.size();
+    if ((int) timesArray.size() < nHorizons) {
+        throw runtime_error("Mission defines " + to_string(timesArray.size()) + " timesets for "
+                            + to_string(nHorizons) + " horizons");
+    }
+    timesArray.resize(nHorizons);
+    offsets.resize((size_t) nDrones * nHorizons);
+    for (int k = 0; k < nDrones; k++) {
+        for (int h = 0; h < nHorizons; h++) {
+            if (h >= (int) droneOffsets[k].size() || droneOffsets[k][h] == string::npos) {
+                throw runtime_error("drone" + to_string(k) + " does not define horizon" + to_string(h));
+            }
+            offsets[(size_t) k * nHorizons + h] = droneOffsets[k][h];
+        }
+    }
+}
+
+vector<Trajectory> IndexedMission::getHorizon(int horizonId) {
+    if (horizonId < 0 || horizonId >= nHorizons) {
+        throw range_error("Horizon " + to_string(horizonId) + " is not in the mission");
+    }
+    lock_guard<mutex> lock(cacheMutex);
+    //horizons before the requested one are not planned again
+    cache.erase(cache.begin(), cache.lower_bound(horizonId));
+    cache.erase(cache.upper_bound(horizonId + window), cache.end());
+    for (int h = horizonId; h <= horizonId + window && h < nHorizons; h++) {
+        if (cache.find(h) == cache.end()) {
+            cache[h] = readHorizon(h);
+        }
+    }
+    return cache[horizonId];
+}
+
+vector<Trajectory> IndexedMission::readHorizon(int horizonId) {
+    vector<Trajectory> trs(nDrones);
+    for (int k = 0; k < nDrones; k++) {
+        const char *cur = file.begin() + offsets[(size_t) k * nHorizons + horizonId];
+        Trajectory &tr = trs[k];
+        tr.pos.reserve(max(nSubgoals, 0));
+        try {
+            readSubgoals(cur, 0, tr);
+        }
+        catch (runtime_error &e) {
+            //the line numbers are not indexed. Count them only to report the error
+            int lineNo = count(file.begin(), cur, '\n');
+            tr.pos.clear();
+            readSubgoals(cur, lineNo, tr);
+        }
+        tr.tList = timesArray[horizonId].times;
+    }
+    return trs;
+}
+
+void IndexedMission::readSubgoals(const char *cur, int lineNo, Trajectory &tr) {
+    MissionParser::Line line;
+    vector<double> values;
+    while (MissionParser::nextLine(cur, file.end(), lineNo, line) && MissionParser::keyEquals(line, "subgoal")) {
+        values.clear();
+        MissionParser::parseNumbers(line, values);
+        if (values.size() != 3) {
+            MissionParser::fail(line, "expected a subgoal of three coordinates");
+        }
+        tr.pos.push_back(Eigen::Vector3d(values[0], values[1], values[2]));
+    }
+}
+
+int IndexedMission::getDrones() const {
+    return nDrones;
+}
+
+int IndexedMission::getHorizons() const {
+    return nHorizons;
+}
+
+int IndexedMission::getSubGoals() const {
+    return nSubgoals;
+}
+
+double IndexedMission::getMovingThreshold() const {
+    return movingThreshold;
+}
+
+double IndexedMission::getHoveringThreshold() const {
+    return hoveringThreshold;
+}
+
+const vector<HorizonTimes> &IndexedMission::getTimesArray() const {
+    return timesArray;
+}
+
+int IndexedMission::getCachedHorizons() {
+    lock_guard<mutex> lock(cacheMutex);
+    return cache.size();
+}
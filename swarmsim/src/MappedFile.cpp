@@ -0,0 +1,76 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile() : data(nullptr), length(0) {}
+
+MappedFile::MappedFile(const string &fPath) : data(nullptr), length(0) {
+    int fd = open(fPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Failed to open " + fPath + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        throw runtime_error("Failed to stat " + fPath + ": " + strerror(err));
+    }
+    length = st.st_size;
+    //an empty file cannot be mapped, it is represented by an empty range
+    if (length > 0) {
+        void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            throw runtime_error("Failed to map " + fPath + ": " + strerror(err));
+        }
+        data = (const char *) addr;
+    }
+    //the mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept : data(other.data), length(other.length) {
+    other.data = nullptr;
+    other.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        release();
+        data = other.data;
+        length = other.length;
+        other.data = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+const char *MappedFile::begin() const {
+    return data;
+}
+
+const char *MappedFile::end() const {
+    return data + length;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+void MappedFile::release() {
+    if (data != nullptr) {
+        munmap((void *) data, length);
+        data = nullptr;
+        length = 0;
+    }
+}
@@ -0,0 +1,37 @@
+#include "MemoryAccounting.h"
+#include <sstream>
+
+atomic<size_t> MemoryAccounting::counters[NMemorySubsystems];
+
+size_t MemoryAccounting::getTotalBytes() {
+    size_t total = 0;
+    for (int i = 0; i < NMemorySubsystems; i++) {
+        total += counters[i];
+    }
+    return total;
+}
+
+const char *MemoryAccounting::getName(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case TrajectoryMemory:
+            return "trajectories";
+        case VisualizationMemory:
+            return "visualization";
+        case RecorderMemory:
+            return "recorder";
+        case RegistryMemory:
+            return "registry";
+        default:
+            return "unknown";
+    }
+}
+
+string MemoryAccounting::report() {
+    ostringstream ss;
+    ss.precision(3);
+    for (int i = 0; i < NMemorySubsystems; i++) {
+        ss << getName((MemorySubsystem) i) << ": " << counters[i] / 1e6 << " MB, ";
+    }
+    ss << "total: " << getTotalBytes() / 1e6 << " MB";
+    return ss.str();
+}
@@ -0,0 +1,172 @@
+#include "MissionCheckpoint.h"
+#include "CompiledMission.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[8] = {'S', 'W', 'A', 'R', 'M', 'C', 'K', 'P'};
+
+    template<typename T>
+    void append(vector<char> &buf, const T &val) {
+        const char *p = (const char *) &val;
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    void appendSeries(vector<char> &buf, const SampleSeries &series) {
+        for (int i = 0; i < (int) series.size(); i++) {
+            append(buf, series[i][0]);
+            append(buf, series[i][1]);
+            append(buf, series[i][2]);
+        }
+    }
+
+    /**
+     * bounds checked cursor over the checkpoint body
+     */
+    class Reader {
+    public:
+        Reader(const char *p, const char *end, const string &fPath) : p(p), end(end), fPath(fPath) {}
+
+        template<typename T>
+        T next() {
+            T val;
+            take(&val, sizeof(T));
+            return val;
+        }
+
+        void take(void *out, size_t n) {
+            if ((size_t) (end - p) < n) {
+                throw runtime_error(fPath + " is truncated");
+            }
+            memcpy(out, p, n);
+            p += n;
+        }
+
+        void readSeries(SampleSeries &series, uint32_t n) {
+            if ((end - p) / (3 * sizeof(double)) < n) {
+                throw runtime_error(fPath + " is truncated");
+            }
+            series.resize(n);
+            for (uint32_t i = 0; i < n; i++) {
+                double v[3];
+                take(v, sizeof(v));
+                series[i] = Eigen::Vector3d(v[0], v[1], v[2]);
+            }
+        }
+
+    private:
+        const char *p;
+        const char *end;
+        const string &fPath;
+    };
+}
+
+void MissionCheckpoint::write(const string &fPath, const SwarmCheckpoint &checkpoint) {
+    vector<char> buf(sizeof(MissionCheckpointHeader), 0);
+    buf.insert(buf.end(), checkpoint.mission.begin(), checkpoint.mission.end());
+    for (const DroneCheckpoint &drone : checkpoint.drones) {
+        append(buf, drone.home[0]);
+        append(buf, drone.home[1]);
+        append(buf, drone.home[2]);
+        append(buf, (int32_t) drone.trajectoryId);
+        append(buf, (int32_t) drone.execPointer);
+        append(buf, (int32_t) drone.trajectories.size());
+        for (const TrajectoryPtr &tr : drone.trajectories) {
+            append(buf, (uint32_t) tr->pos.size());
+            append(buf, (uint32_t) tr->vel.size());
+            append(buf, (uint32_t) tr->acc.size());
+            append(buf, (uint32_t) tr->tList.size());
+            appendSeries(buf, tr->pos);
+            appendSeries(buf, tr->vel);
+            appendSeries(buf, tr->acc);
+            for (double t : tr->tList) {
+                append(buf, t);
+            }
+        }
+    }
+
+    MissionCheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.nDrones = checkpoint.drones.size();
+    header.horizonId = checkpoint.horizonId;
+    header.nHorizons = checkpoint.nHorizons;
+    header.missionLength = checkpoint.mission.size();
+    header.fileSize = buf.size();
+    header.checksum = CompiledMission::checksum(buf.data() + sizeof(header), buf.data() + buf.size());
+    memcpy(buf.data(), &header, sizeof(header));
+
+    string tmpPath = fPath + ".tmp";
+    {
+        ofstream out(tmpPath.c_str(), ios::out | ios::binary | ios::trunc);
+        out.write(buf.data(), buf.size());
+        if (!out) {
+            throw runtime_error("Failed to write " + tmpPath);
+        }
+    }
+    if (rename(tmpPath.c_str(), fPath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        throw runtime_error("Failed to replace " + fPath);
+    }
+}
+
+SwarmCheckpoint MissionCheckpoint::read(const string &fPath) {
+    MappedFile file(fPath);
+    if (file.size() < sizeof(MissionCheckpointHeader)) {
+        throw runtime_error(fPath + " is too small to be a checkpoint");
+    }
+    MissionCheckpointHeader header;
+    memcpy(&header, file.begin(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error(fPath + " is not a checkpoint");
+    }
+    if (header.version != VERSION) {
+        throw runtime_error(fPath + " has version " + to_string(header.version) + ", expected "
+                            + to_string(VERSION));
+    }
+    if (header.fileSize != file.size()) {
+        throw runtime_error(fPath + " is truncated");
+    }
+    if (CompiledMission::checksum(file.begin() + sizeof(header), file.end()) != header.checksum) {
+        throw runtime_error(fPath + " failed the checksum");
+    }
+
+    Reader reader(file.begin() + sizeof(header), file.end(), fPath);
+    SwarmCheckpoint checkpoint;
+    checkpoint.horizonId = header.horizonId;
+    checkpoint.nHorizons = header.nHorizons;
+    checkpoint.mission.resize(header.missionLength);
+    reader.take(&checkpoint.mission[0], header.missionLength);
+    checkpoint.drones.resize(header.nDrones);
+    for (DroneCheckpoint &drone : checkpoint.drones) {
+        reader.take(drone.home.data(), 3 * sizeof(double));
+        drone.trajectoryId = reader.next<int32_t>();
+        drone.execPointer = reader.next<int32_t>();
+        int32_t nTrajectories = reader.next<int32_t>();
+        if (nTrajectories < 1 || drone.trajectoryId < 0 || drone.execPointer < 0) {
+            throw runtime_error(fPath + " has an invalid drone entry");
+        }
+        for (int32_t j = 0; j < nTrajectories; j++) {
+            uint32_t nPos = reader.next<uint32_t>();
+            uint32_t nVel = reader.next<uint32_t>();
+            uint32_t nAcc = reader.next<uint32_t>();
+            uint32_t nTimes = reader.next<uint32_t>();
+            auto tr = make_shared<Trajectory>();
+            reader.readSeries(tr->pos, nPos);
+            reader.readSeries(tr->vel, nVel);
+            reader.readSeries(tr->acc, nAcc);
+            for (uint32_t i = 0; i < nTimes; i++) {
+                tr->tList.push_back(reader.next<double>());
+            }
+            drone.trajectories.push_back(tr);
+        }
+        if (drone.execPointer >= (int) drone.trajectories[0]->pos.size()) {
+            throw runtime_error(fPath + " has an invalid drone entry");
+        }
+    }
+    return checkpoint;
+}
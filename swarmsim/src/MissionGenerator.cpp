@@ -0,0 +1,110 @@
+#include "MissionGenerator.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    FILE *openForWriting(const string &fPath) {
+        FILE *fh = fopen(fPath.c_str(), "w");
+        if (fh == NULL) {
+            throw runtime_error("Failed to create " + fPath);
+        }
+        return fh;
+    }
+}
+
+MissionGenerator::MissionGenerator(const MissionSpec &spec) : spec(spec) {
+    mt19937 rng(spec.seed);
+    uniform_real_distribution<double> heading(-M_PI, M_PI);
+    uniform_real_distribution<double> step(1, 4);
+    int nPoints = spec.nHorizons * (spec.nSubgoals - 1) + 1;
+    subgoals.resize(spec.nDrones);
+    Eigen::Vector3d lo = Eigen::Vector3d::Constant(numeric_limits<double>::max());
+    Eigen::Vector3d hi = -lo;
+    for (int k = 0; k < spec.nDrones; k++) {
+        vector<Eigen::Vector3d> &path = subgoals[k];
+        path.reserve(nPoints);
+        path.push_back(Eigen::Vector3d(2 * k, 0, 2.5));
+        for (int j = 1; j < nPoints; j++) {
+            double theta = heading(rng);
+            path.push_back(path.back() + step(rng) * Eigen::Vector3d(cos(theta), sin(theta), 0));
+        }
+        for (const Eigen::Vector3d &p : path) {
+            lo = lo.cwiseMin(p);
+            hi = hi.cwiseMax(p);
+        }
+    }
+
+    //obstacles are scattered over the area the drones fly in
+    uniform_real_distribution<double> unit(0, 1);
+    uniform_real_distribution<double> size(1, 5);
+    for (int i = 0; i < spec.nObstacles; i++) {
+        Obstacle ob;
+        ob.center = Eigen::Vector3d(lo[0] + unit(rng) * (hi[0] - lo[0]), lo[1] + unit(rng) * (hi[1] - lo[1]), 2.5);
+        ob.height = 5;
+        ob.width = size(rng);
+        ob.length = size(rng);
+        obstacles.push_back(ob);
+    }
+}
+
+void MissionGenerator::writeMission(const string &fPath) {
+    FILE *fh = openForWriting(fPath);
+    fprintf(fh, "#Header (Meta information)\nhorizons: %d\nsubgoals: %d\ndrones: %d\n\n#Body\ntimes:\n",
+            spec.nHorizons, spec.nSubgoals, spec.nDrones);
+    for (int h = 0; h < spec.nHorizons; h++) {
+        fprintf(fh, "  timeset%d: [", h);
+        for (int j = 0; j < spec.nSubgoals - 1; j++) {
+            fprintf(fh, j == 0 ? "%g" : ",%g", spec.segmentTime);
+        }
+        fprintf(fh, "]\n");
+    }
+    for (int k = 0; k < spec.nDrones; k++) {
+        fprintf(fh, "\ndrone%d:\n", k);
+        for (int h = 0; h < spec.nHorizons; h++) {
+            fprintf(fh, "  horizon%d:\n", h);
+            for (int j = 0; j < spec.nSubgoals; j++) {
+                const Eigen::Vector3d &p = subgoals[k][h * (spec.nSubgoals - 1) + j];
+                fprintf(fh, "    subgoal: [%.2f, %.2f, %.2f]\n", p[0], p[1], p[2]);
+            }
+        }
+    }
+    fprintf(fh, "\n  # testing threasholds (meters)\n  movingThreshold: 2\n  hoveringThreshold: 1\n");
+    fclose(fh);
+}
+
+void MissionGenerator::writeObstacles(const string &fPath) {
+    FILE *fh = openForWriting(fPath);
+    fprintf(fh, "# length: along the x axis\n# width: along the y axis\n");
+    for (const Obstacle &ob : obstacles) {
+        fprintf(fh, "\nobstacle:\n  center: [%.2f, %.2f, %.2f]\n  height: %g\n  width: %.2f\n  length: %.2f\n",
+                ob.center[0], ob.center[1], ob.center[2], ob.height, ob.width, ob.length);
+    }
+    fclose(fh);
+}
+
+void MissionGenerator::writeTrajectories(const string &dir) {
+    int samplesPerSegment = max((int) round(spec.segmentTime * spec.frequency), 1);
+    for (int k = 0; k < spec.nDrones; k++) {
+        stringstream ss;
+        ss << dir << "pos_" << k << ".txt";
+        FILE *fh = openForWriting(ss.str());
+        const vector<Eigen::Vector3d> &path = subgoals[k];
+        for (int j = 0; j + 1 < (int) path.size(); j++) {
+            for (int i = 0; i < samplesPerSegment; i++) {
+                Eigen::Vector3d p = path[j] + (path[j + 1] - path[j]) * ((double) i / samplesPerSegment);
+                fprintf(fh, "%.4f\t%.4f\t%.4f\n", p[0], p[1], p[2]);
+            }
+        }
+        fprintf(fh, "%.4f\t%.4f\t%.4f\n", path.back()[0], path.back()[1], path.back()[2]);
+        fclose(fh);
+    }
+}
+
+const vector<Eigen::Vector3d> &MissionGenerator::getSubgoals(int droneId) {
+    return subgoals[droneId];
+}
@@ -0,0 +1,285 @@
+#include "MissionParser.h"
+#include <ros/console.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+
+using namespace Eigen;
+
+namespace {
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    void trim(const char *&b, const char *&e) {
+        while (b < e && isSpace(*b)) b++;
+        while (e > b && isSpace(*(e - 1))) e--;
+    }
+}
+
+void MissionParser::parseFile(const string &fPath, YamlDescriptor &yamlDescriptor) {
+    string buf = readFile(fPath);
+    parse(buf.data(), buf.data() + buf.size(), yamlDescriptor);
+    ROS_DEBUG_STREAM("Finished parsing the mission file " << fPath);
+}
+
+string MissionParser::readFile(const string &fPath) {
+    ifstream in(fPath.c_str(), ios::in | ios::binary);
+    if (!in) {
+        throw runtime_error("Failed to open the mission file " + fPath);
+    }
+    in.seekg(0, ios::end);
+    string buf;
+    buf.resize(in.tellg());
+    in.seekg(0, ios::beg);
+    in.read(&buf[0], buf.size());
+    if (!in) {
+        throw runtime_error("Failed to read the mission file " + fPath);
+    }
+    return buf;
+}
+
+void MissionParser::parse(const char *begin, const char *end, YamlDescriptor &yamlDescriptor) {
+    int nDronesHeader = -1;
+    int nHorizonsHeader = -1;
+    int nSubgoals = -1;
+    int currDrone = -1;
+    int currHorizon = -1;
+    vector<DroneTrajectory> dronesTrajList;
+    vector<HorizonTimes> horizonsTimes;
+    vector<double> values;
+
+    const char *cur = begin;
+    int lineNo = 0;
+    Line line;
+    int idx;
+    while (nextLine(cur, end, lineNo, line)) {
+        if (keyEquals(line, "subgoal")) {
+            if (currDrone < 0 || currHorizon < 0) {
+                fail(line, "subgoal outside of a drone horizon");
+            }
+            values.clear();
+            parseNumbers(line, values);
+            if (values.size() != 3) {
+                fail(line, "expected a subgoal of three coordinates");
+            }
+            SampleSeries &pos = dronesTrajList[currDrone].horzTrajList[currHorizon].pos;
+            if (pos.empty() && nSubgoals > 0) {
+                pos.reserve(nSubgoals);
+            }
+            pos.push_back(Vector3d(values[0], values[1], values[2]));
+        } else if (currDrone >= 0 && parseIndexedKey(line, "horizon", idx)) {
+            currHorizon = idx;
+            vector<Trajectory> &horizons = dronesTrajList[currDrone].horzTrajList;
+            if ((int) horizons.size() <= idx) {
+                horizons.resize(idx + 1);
+            }
+        } else if (parseIndexedKey(line, "drone", idx)) {
+            currDrone = idx;
+            currHorizon = -1;
+            if ((int) dronesTrajList.size() <= idx) {
+                dronesTrajList.resize(idx + 1);
+            }
+        } else if (parseIndexedKey(line, "timeset", idx)) {
+            if ((int) horizonsTimes.size() <= idx) {
+                horizonsTimes.resize(idx + 1);
+            }
+            horizonsTimes[idx].times.clear();
+            parseNumbers(line, horizonsTimes[idx].times);
+        } else if (keyEquals(line, "times")) {
+            currDrone = -1;
+            currHorizon = -1;
+        } else if (keyEquals(line, "drones")) {
+            nDronesHeader = (int) parseNumber(line);
+        } else if (keyEquals(line, "horizons")) {
+            nHorizonsHeader = (int) parseNumber(line);
+        } else if (keyEquals(line, "subgoals")) {
+            nSubgoals = (int) parseNumber(line);
+        } else if (keyEquals(line, "movingThreshold")) {
+            yamlDescriptor.setMovingThreshold(parseNumber(line));
+        } else if (keyEquals(line, "hoveringThreshold")) {
+            yamlDescriptor.setHoveringThreshold(parseNumber(line));
+        }
+    }
+
+    int nDrones = dronesTrajList.size();
+    int nHorizons = nHorizonsHeader >= 0 ? nHorizonsHeader : horizonsTimes.size();
+    if (nDronesHeader >= 0 && nDronesHeader != nDrones) {
+        ROS_WARN_STREAM("Mission header declares " << nDronesHeader << " drones but " << nDrones << " are defined");
+    }
+    if ((int) horizonsTimes.size() < nHorizons) {
+        throw runtime_error("Mission defines " + to_string(horizonsTimes.size()) + " timesets for "
+                            + to_string(nHorizons) + " horizons");
+    }
+    for (int i = 0; i < nDrones; i++) {
+        if ((int) dronesTrajList[i].horzTrajList.size() < nHorizons) {
+            throw runtime_error("drone" + to_string(i) + " defines " + to_string(dronesTrajList[i].horzTrajList.size())
+                                + " of " + to_string(nHorizons) + " horizons");
+        }
+    }
+    horizonsTimes.resize(nHorizons);
+
+    yamlDescriptor.setDrones(nDrones);
+    yamlDescriptor.setHorizons(nHorizons);
+    yamlDescriptor.setSubGoals(nSubgoals);
+    yamlDescriptor.setTimesArray(move(horizonsTimes));
+    yamlDescriptor.setDronesTrajectories(move(dronesTrajList));
+}
+
+bool MissionParser::nextLine(const char *&cur, const char *end, int &lineNo, Line &line) {
+    while (cur < end) {
+        const char *b = cur;
+        const char *e = (const char *) memchr(cur, '\n', end - cur);
+        if (e == nullptr) {
+            e = end;
+        }
+        cur = e < end ? e + 1 : end;
+        lineNo++;
+
+        line.lineBegin = b;
+        line.lineNo = lineNo;
+        const char *hash = (const char *) memchr(b, '#', e - b);
+        if (hash != nullptr) {
+            e = hash;
+        }
+        trim(b, e);
+        if (b == e || *b == '-' || (e - b >= 3 && strncmp(b, "...", 3) == 0)) {
+            //empty, comment or document marker
+            continue;
+        }
+        const char *colon = (const char *) memchr(b, ':', e - b);
+        if (colon == nullptr) {
+            fail(line, "expected a key: value pair");
+        }
+        line.keyBegin = b;
+        line.keyEnd = colon;
+        trim(line.keyBegin, line.keyEnd);
+        line.valueBegin = colon + 1;
+        line.valueEnd = e;
+        trim(line.valueBegin, line.valueEnd);
+
+        //a flow sequence may be continued on the next lines
+        if (line.valueBegin < line.valueEnd && *line.valueBegin == '['
+            && memchr(line.valueBegin, ']', line.valueEnd - line.valueBegin) == nullptr) {
+            const char *close = (const char *) memchr(line.valueEnd, ']', end - line.valueEnd);
+            if (close == nullptr) {
+                fail(line, "unterminated sequence");
+            }
+            for (const char *p = cur; p < close; p++) {
+                lineNo += *p == '\n';
+            }
+            line.valueEnd = close + 1;
+            const char *nl = (const char *) memchr(close, '\n', end - close);
+            cur = nl == nullptr ? end : nl + 1;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool MissionParser::keyEquals(const Line &line, const char *key) {
+    size_t len = strlen(key);
+    return (size_t) (line.keyEnd - line.keyBegin) == len && memcmp(line.keyBegin, key, len) == 0;
+}
+
+bool MissionParser::parseIndexedKey(const Line &line, const char *prefix, int &idx) {
+    size_t len = strlen(prefix);
+    if ((size_t) (line.keyEnd - line.keyBegin) <= len || memcmp(line.keyBegin, prefix, len) != 0) {
+        return false;
+    }
+    long val = 0;
+    for (const char *p = line.keyBegin + len; p < line.keyEnd; p++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        val = val * 10 + (*p - '0');
+        if (val > 100000000) {
+            fail(line, "index out of range");
+        }
+    }
+    idx = (int) val;
+    return true;
+}
+
+void MissionParser::parseNumbers(const Line &line, vector<double> &out) {
+    const char *p = line.valueBegin;
+    const char *e = line.valueEnd;
+    if (p < e && *p == '[') {
+        if (*(e - 1) != ']') {
+            fail(line, "expected ] at the end of the sequence");
+        }
+        p++;
+        e--;
+    }
+    while (p < e) {
+        while (p < e && (isSpace(*p) || *p == ',' || *p == '\n')) p++;
+        if (p == e) {
+            break;
+        }
+        const char *q = p;
+        while (q < e && !isSpace(*q) && *q != ',' && *q != '\n') q++;
+        double val;
+        if (!parseDouble(p, q, val)) {
+            fail(line, "expected a number but found \"" + string(p, q) + "\"");
+        }
+        out.push_back(val);
+        p = q;
+    }
+}
+
+bool MissionParser::parseDouble(const char *p, const char *e, double &val) {
+    //plain decimals such as -12.50 are parsed directly. The mantissa and the power of ten
+    //are both exact doubles, so the division is correctly rounded
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15};
+    const char *q = p;
+    bool negative = q < e && *q == '-';
+    if (q < e && (*q == '-' || *q == '+')) q++;
+    long long mantissa = 0;
+    int digits = 0;
+    int fracDigits = -1;
+    for (; q < e; q++) {
+        if (*q >= '0' && *q <= '9') {
+            mantissa = mantissa * 10 + (*q - '0');
+            digits++;
+            if (fracDigits >= 0) fracDigits++;
+        } else if (*q == '.' && fracDigits < 0) {
+            fracDigits = 0;
+        } else {
+            break;
+        }
+    }
+    if (q == e && digits > 0 && digits <= 15) {
+        val = fracDigits > 0 ? mantissa / pow10[fracDigits] : mantissa;
+        if (negative) val = -val;
+        return true;
+    }
+    //anything else (exponents, long mantissas) goes through strtod on a terminated copy,
+    //the buffer may not be terminated after the number
+    char num[64];
+    if ((size_t) (e - p) >= sizeof(num) || e == p) {
+        return false;
+    }
+    memcpy(num, p, e - p);
+    num[e - p] = '\0';
+    char *parsedEnd;
+    val = strtod(num, &parsedEnd);
+    return parsedEnd == num + (e - p);
+}
+
+double MissionParser::parseNumber(const Line &line) {
+    vector<double> values;
+    parseNumbers(line, values);
+    if (values.size() != 1) {
+        fail(line, "expected a single number");
+    }
+    return values[0];
+}
+
+void MissionParser::fail(const Line &line, const string &msg) {
+    stringstream ss;
+    ss << "Mission file line " << line.lineNo << ": " << msg;
+    throw runtime_error(ss.str());
+}
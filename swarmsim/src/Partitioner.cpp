@@ -0,0 +1,110 @@
+#include "Partitioner.h"
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+Partitioner::Partitioner(double cellSize, double minSeparation)
+        : cellSize(cellSize), minSeparation(minSeparation) {}
+
+Partition Partitioner::partition(const vector<Trajectory> &droneWpts) {
+    Partition p;
+    int nDrones = droneWpts.size();
+    p.clusterOf.resize(nDrones);
+    p.regions.resize(nDrones);
+
+    //each drone is clustered by the cell of the center of its inflated waypoint region
+    unordered_map<long long, int> clusterIds;
+    for (int k = 0; k < nDrones; k++) {
+        Eigen::AlignedBox3d region;
+        for (size_t i = 0; i < droneWpts[k].pos.size(); i++) {
+            region.extend(droneWpts[k].pos[i]);
+        }
+        if (region.isEmpty()) {
+            region.extend(Eigen::Vector3d::Zero());
+        }
+        Eigen::Vector3d margin = Eigen::Vector3d::Constant(minSeparation);
+        region = Eigen::AlignedBox3d(region.min() - margin, region.max() + margin);
+        p.regions[k] = region;
+
+        long long key = getCellKey(getCell(region.center()));
+        auto it = clusterIds.find(key);
+        if (it == clusterIds.end()) {
+            it = clusterIds.emplace(key, p.clusters.size()).first;
+            p.clusters.push_back(vector<int>());
+        }
+        p.clusters[it->second].push_back(k);
+        p.clusterOf[k] = it->second;
+    }
+
+    //a drone whose region reaches into other cells may meet the drones registered there
+    unordered_map<long long, vector<int> > cellOccupants;
+    for (int k = 0; k < nDrones; k++) {
+        Eigen::Vector3i lo = getCell(p.regions[k].min());
+        Eigen::Vector3i hi = getCell(p.regions[k].max());
+        for (int x = lo[0]; x <= hi[0]; x++) {
+            for (int y = lo[1]; y <= hi[1]; y++) {
+                for (int z = lo[2]; z <= hi[2]; z++) {
+                    cellOccupants[getCellKey(Eigen::Vector3i(x, y, z))].push_back(k);
+                }
+            }
+        }
+    }
+    for (auto &cell : cellOccupants) {
+        vector<int> &occupants = cell.second;
+        for (size_t i = 0; i < occupants.size(); i++) {
+            for (size_t j = i + 1; j < occupants.size(); j++) {
+                int a = occupants[i], b = occupants[j];
+                if (p.clusterOf[a] != p.clusterOf[b] && p.regions[a].intersects(p.regions[b])) {
+                    p.boundaryPairs.push_back(make_pair(min(a, b), max(a, b)));
+                }
+            }
+        }
+    }
+    sort(p.boundaryPairs.begin(), p.boundaryPairs.end());
+    p.boundaryPairs.erase(unique(p.boundaryPairs.begin(), p.boundaryPairs.end()), p.boundaryPairs.end());
+    return p;
+}
+
+vector<pair<int, int> > Partitioner::findConflicts(const vector<int> &cluster, const Partition &partition,
+                                                   const vector<TrajectoryPtr> &trajs) {
+    vector<pair<int, int> > candidates;
+    for (size_t i = 0; i < cluster.size(); i++) {
+        for (size_t j = i + 1; j < cluster.size(); j++) {
+            if (partition.regions[cluster[i]].intersects(partition.regions[cluster[j]])) {
+                candidates.push_back(make_pair(cluster[i], cluster[j]));
+            }
+        }
+    }
+    return findConflicts(candidates, trajs);
+}
+
+vector<pair<int, int> > Partitioner::findConflicts(const vector<pair<int, int> > &candidates,
+                                                   const vector<TrajectoryPtr> &trajs) {
+    vector<pair<int, int> > conflicts;
+    for (const pair<int, int> &c : candidates) {
+        if (minDistance(*trajs[c.first], *trajs[c.second]) < minSeparation) {
+            conflicts.push_back(c);
+        }
+    }
+    return conflicts;
+}
+
+double Partitioner::minDistance(const Trajectory &a, const Trajectory &b) {
+    double dist = numeric_limits<double>::max();
+    int n = min(a.pos.size(), b.pos.size());
+    for (int i = 0; i < n; i++) {
+        dist = min(dist, (a.pos[i] - b.pos[i]).norm());
+    }
+    return dist;
+}
+
+Eigen::Vector3i Partitioner::getCell(const Eigen::Vector3d &p) {
+    return Eigen::Vector3i((int) floor(p[0] / cellSize), (int) floor(p[1] / cellSize),
+                           (int) floor(p[2] / cellSize));
+}
+
+long long Partitioner::getCellKey(const Eigen::Vector3i &cell) {
+    const long long mask = (1LL << 21) - 1;
+    return ((cell[0] & mask) << 42) | ((cell[1] & mask) << 21) | (cell[2] & mask);
+}
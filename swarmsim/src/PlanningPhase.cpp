@@ -1,37 +1,186 @@
 #include "PlanningPhase.h"
 #include<ros/console.h>
 
-PlanningPhase::PlanningPhase() {}
+PlanningPhase::PlanningPhase() : planning_t(nullptr), planningRound(0) {}
 
 PlanningPhase::PlanningPhase(int nDrones, double frequency) : nDrones(nDrones), frequency(frequency) {
     maxVelocity = 4;
     maxAcceleration = 4;
     doneInitPlanning = false;
+    planning_t = nullptr;
+    lookahead = 0;
+    speculationThreshold = 0.1;
+    planningRound = 0;
+    partitionCellSize = 10;
+    minSeparation = 0.5;
 }
 
-vector<Trajectory> PlanningPhase::computeSmoothTrajectories(bool initialQP, bool lastQP, std::vector<Trajectory> prevPlan) {
+PlanningPhase::~PlanningPhase() {
+    stopSpeculation();
+}
+
+vector<TrajectoryPtr> PlanningPhase::computeSmoothTrajectories(bool initialQP, bool lastQP,
+                                                               const std::vector<TrajectoryPtr> &prevPlan) {
+    return computeSmoothTrajectories(discreteWpts, initialQP, lastQP, prevPlan);
+}
+
+vector<TrajectoryPtr> PlanningPhase::computeSmoothTrajectories(const vector<Trajectory> &wpts, bool initialQP, bool lastQP,
+                                                               const std::vector<TrajectoryPtr> &prevPlan) {
     Solver* solver = new Solver(nDrones, maxVelocity, maxAcceleration, frequency);
-    vector<Trajectory> results = solver->solve(discreteWpts, initialQP, lastQP, prevPlan);
+    solver->setPartitioning(partitionCellSize, minSeparation);
+    vector<TrajectoryPtr> results = solver->solve(wpts, initialQP, lastQP, prevPlan);
     delete solver;
     return results;
 }
 
-vector<Trajectory> PlanningPhase::getPlanningResults() {
-    //wait for the initial planning to finish
-    do {
-        ROS_DEBUG_ONCE("Waiting for initial planning to finish");
-    }
-    while(!doneInitPlanning); 
-    planning_t->join();
-    vector<Trajectory> results;
+vector<TrajectoryPtr> PlanningPhase::getPlanningResults() {
+    //blocks until the planning thread hands over the committed plan. The thread itself
+    //may keep running to plan the lookahead horizons, so it is joined on the next doPlanning.
+    ROS_DEBUG_ONCE("Waiting for initial planning to finish");
+    vector<TrajectoryPtr> results;
     try {
         results = fut.get();
     }
     catch(future_error& e) {
         ROS_ERROR_STREAM("Caught a future_error while getting the future\"" << e.what());
     }
+    catch (range_error &e) {
+        ROS_ERROR_STREAM("No plan to hand over. " << e.what());
+    }
     return results;
 }
 
-void PlanningPhase::doPlanning(int horizonId, std::vector<Trajectory> prevPlan) {}
+bool PlanningPhase::pushWaypoints(WaypointUpdate update) {
+    return waypointQueue.push(move(update));
+}
+
+bool PlanningPhase::applyWaypointUpdates(vector<Trajectory> &wpts) {
+    bool applied = false;
+    WaypointUpdate update;
+    while (waypointQueue.pop(update)) {
+        if (update.droneId < 0 || update.droneId >= (int) wpts.size() || wpts[update.droneId].pos.empty()) {
+            ROS_WARN_STREAM("Waypoints rejected. Unknown drone: " << update.droneId);
+            continue;
+        }
+        if (update.wpts.pos.empty() || update.wpts.pos.size() != update.wpts.tList.size()) {
+            ROS_WARN_STREAM("Waypoints rejected for drone " << update.droneId
+                                    << ". Expected one time per subgoal");
+            continue;
+        }
+        Trajectory &tr = wpts[update.droneId];
+        Eigen::Vector3d start = tr.pos[0];
+        tr.pos.clear();
+        tr.pos.push_back(start);
+        tr.pos.append(update.wpts.pos);
+        tr.tList = update.wpts.tList;
+        ROS_DEBUG_STREAM("Applied " << update.wpts.pos.size() << " streamed subgoals to drone " << update.droneId);
+        applied = true;
+    }
+    return applied;
+}
+
+void PlanningPhase::speculate(int fromHorizon, vector<TrajectoryPtr> seedPlan, int round) {
+    for (int h = fromHorizon; h < fromHorizon + lookahead && h < nHorizons; h++) {
+        if (planningRound != round) {
+            return;
+        }
+        vector<Eigen::Vector3d> seed = getEndPositions(seedPlan);
+        {
+            lock_guard<mutex> lock(speculationMutex);
+            auto it = speculativePlans.find(h);
+            if (it != speculativePlans.end() && it->second.seed == seed) {
+                //already chained on the same state in a previous round
+                seedPlan = it->second.plan;
+                continue;
+            }
+        }
+        vector<TrajectoryPtr> plan;
+        try {
+            plan = computeSmoothTrajectories(getDiscretePlan(h), isInitialHorizon(h), isLastHorizon(h), seedPlan);
+        }
+        catch (range_error &e) {
+            ROS_WARN_STREAM("Speculative planning stopped at horizon " << h << ". " << e.what());
+            return;
+        }
+        ROS_DEBUG_STREAM("Speculative plan ready for horizon " << h);
+        {
+            lock_guard<mutex> lock(speculationMutex);
+            SpeculativePlan &sp = speculativePlans[h];
+            sp.seed = seed;
+            sp.plan = plan;
+        }
+        seedPlan = move(plan);
+    }
+}
+
+bool PlanningPhase::takeSpeculativePlan(int horizonId, const vector<Eigen::Vector3d> &expectedStart,
+                                        vector<TrajectoryPtr> &plan) {
+    lock_guard<mutex> lock(speculationMutex);
+    auto it = speculativePlans.find(horizonId);
+    if (it == speculativePlans.end()) {
+        return false;
+    }
+    SpeculativePlan sp = move(it->second);
+    speculativePlans.erase(speculativePlans.begin(), ++it);
+
+    if (expectedStart.size() != sp.seed.size()) {
+        speculativePlans.clear();
+        return false;
+    }
+    for (size_t i = 0; i < expectedStart.size(); i++) {
+        if ((expectedStart[i] - sp.seed[i]).norm() > speculationThreshold) {
+            ROS_DEBUG_STREAM("Speculative plan for horizon " << horizonId << " invalidated. Drone " << i
+                                     << " drifted " << (expectedStart[i] - sp.seed[i]).norm());
+            //later plans are chained on this one, so they are stale as well
+            speculativePlans.clear();
+            return false;
+        }
+    }
+    plan = move(sp.plan);
+    return true;
+}
+
+void PlanningPhase::invalidateSpeculativePlans(int horizonId) {
+    lock_guard<mutex> lock(speculationMutex);
+    speculativePlans.erase(speculativePlans.lower_bound(horizonId), speculativePlans.end());
+}
+
+void PlanningPhase::shutdown() {
+    stopSpeculation();
+    invalidateSpeculativePlans(0);
+    discreteWpts.clear();
+}
+
+void PlanningPhase::stopSpeculation() {
+    if (planning_t == nullptr) {
+        return;
+    }
+    planningRound++;
+    if (planning_t->joinable()) {
+        planning_t->join();
+    }
+    delete planning_t;
+    planning_t = nullptr;
+}
+
+bool PlanningPhase::isInitialHorizon(int horizonId) {
+    return horizonId == 0;
+}
+
+bool PlanningPhase::isLastHorizon(int horizonId) {
+    return horizonId == nHorizons;
+}
+
+vector<Eigen::Vector3d> PlanningPhase::getEndPositions(const vector<TrajectoryPtr> &plan) {
+    vector<Eigen::Vector3d> ends;
+    for (const TrajectoryPtr &tr : plan) {
+        if (!tr->pos.empty()) {
+            ends.push_back(tr->pos[tr->pos.size() - 1]);
+        }
+    }
+    return ends;
+}
+
+void PlanningPhase::doPlanning(int horizonId, std::vector<TrajectoryPtr> prevPlan,
+                               vector<Eigen::Vector3d> expectedStart) {}
 vector<Trajectory> PlanningPhase::getDiscretePlan(int horizonId) {}
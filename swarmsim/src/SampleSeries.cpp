@@ -0,0 +1,143 @@
+#include "SampleSeries.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+SampleSeries::SampleSeries() : block(nullptr), n(0), cap(0), owned(false) {}
+
+SampleSeries::SampleSeries(const SampleSeries &other) : block(nullptr), n(0), cap(0), owned(false) {
+    append(other);
+}
+
+SampleSeries::SampleSeries(SampleSeries &&other) noexcept : block(other.block), n(other.n), cap(other.cap),
+                                                             owned(other.owned) {
+    other.block = nullptr;
+    other.n = 0;
+    other.cap = 0;
+    other.owned = false;
+}
+
+SampleSeries &SampleSeries::operator=(const SampleSeries &other) {
+    if (this != &other) {
+        //an attached block belongs to an arena that need not outlive this series, copies own their samples
+        if (!owned) {
+            release();
+        }
+        clear();
+        append(other);
+    }
+    return *this;
+}
+
+SampleSeries &SampleSeries::operator=(SampleSeries &&other) noexcept {
+    if (this != &other) {
+        release();
+        block = other.block;
+        n = other.n;
+        cap = other.cap;
+        owned = other.owned;
+        other.block = nullptr;
+        other.n = 0;
+        other.cap = 0;
+        other.owned = false;
+    }
+    return *this;
+}
+
+SampleSeries::~SampleSeries() {
+    release();
+}
+
+void SampleSeries::reserve(size_t capacity) {
+    if (capacity > cap) {
+        reallocate(alignCapacity(capacity));
+    }
+}
+
+void SampleSeries::resize(size_t size) {
+    reserve(size);
+    for (int dim = 0; dim < 3 && size > n; dim++) {
+        std::fill(data(dim) + n, data(dim) + size, 0.0);
+    }
+    n = size;
+}
+
+void SampleSeries::push_back(const Eigen::Vector3d &v) {
+    if (n == cap) {
+        reallocate(alignCapacity(std::max<size_t>(2 * cap, 8)));
+    }
+    block[n] = v[0];
+    block[cap + n] = v[1];
+    block[2 * cap + n] = v[2];
+    n++;
+}
+
+void SampleSeries::append(const SampleSeries &other, size_t first, size_t last) {
+    size_t count = last - first;
+    if (count == 0) {
+        return;
+    }
+    if (n + count > cap) {
+        reallocate(alignCapacity(std::max(n + count, 2 * cap)));
+    }
+    for (int dim = 0; dim < 3; dim++) {
+        memcpy(data(dim) + n, other.data(dim) + first, count * sizeof(double));
+    }
+    n += count;
+}
+
+void SampleSeries::append(const SampleSeries &other) {
+    append(other, 0, other.size());
+}
+
+void SampleSeries::attach(double *storage, size_t capacity) {
+    attach(storage, capacity, capacity);
+}
+
+void SampleSeries::attach(double *storage, size_t capacity, size_t size) {
+    release();
+    block = storage;
+    cap = capacity;
+    n = size;
+    owned = false;
+}
+
+bool SampleSeries::operator==(const SampleSeries &other) const {
+    if (n != other.n) {
+        return false;
+    }
+    for (int dim = 0; dim < 3; dim++) {
+        if (!std::equal(data(dim), data(dim) + n, other.data(dim))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SampleSeries::reallocate(size_t capacity) {
+    void *storage = nullptr;
+    if (posix_memalign(&storage, 64, 3 * capacity * sizeof(double)) != 0) {
+        throw std::bad_alloc();
+    }
+    double *grown = (double *) storage;
+    MemoryAccounting::allocated(TrajectoryMemory, 3 * capacity * sizeof(double));
+    for (int dim = 0; dim < 3 && n > 0; dim++) {
+        memcpy(grown + dim * capacity, data(dim), n * sizeof(double));
+    }
+    release();
+    block = grown;
+    cap = capacity;
+    owned = true;
+}
+
+void SampleSeries::release() {
+    if (owned) {
+        free(block);
+        MemoryAccounting::released(TrajectoryMemory, 3 * cap * sizeof(double));
+    }
+    block = nullptr;
+    cap = 0;
+    owned = false;
+}
@@ -0,0 +1,69 @@
+#include "SegmentExecutor.h"
+#include <geometry_msgs/PoseStamped.h>
+#include <mavros_msgs/PositionTarget.h>
+#include <ros/console.h>
+#include <sstream>
+
+namespace {
+    string getTopic(int droneId, const string &topic) {
+        stringstream ss;
+        ss << "/" << droneId << "/" << topic;
+        return ss.str();
+    }
+}
+
+SegmentExecutor::SegmentExecutor(int droneId, const ros::NodeHandle &n, bool feedforward)
+        : droneId(droneId), feedforward(feedforward), nh(n) {
+    segmentsSub = nh.subscribe(getTopic(droneId, "swarm/segments"), 10, &SegmentExecutor::segmentsCB, this);
+    targetMsg.coordinate_frame = mavros_msgs::PositionTarget::FRAME_LOCAL_NED;
+    targetMsg.type_mask = mavros_msgs::PositionTarget::IGNORE_YAW | mavros_msgs::PositionTarget::IGNORE_YAW_RATE;
+    if (feedforward) {
+        rawSetPointPub = nh.advertise<mavros_msgs::PositionTarget>(getTopic(droneId, "mavros/setpoint_raw/local"), 10);
+    } else {
+        posSetPointPub = nh.advertise<geometry_msgs::PoseStamped>(getTopic(droneId, "mavros/setpoint_position/local"),
+                                                                  10);
+    }
+}
+
+void SegmentExecutor::segmentsCB(const std_msgs::Float64MultiArrayConstPtr &msg) {
+    SegmentedTrajectory tr;
+    if (!SegmentedTrajectory::decode(msg->data, tr)) {
+        ROS_WARN_STREAM("Drone: " << droneId << " received malformed segments");
+        return;
+    }
+    ROS_DEBUG_STREAM("Drone: " << droneId << " received horizon " << tr.trajectoryId << ", " << tr.segments.size()
+                               << " segments starting at " << tr.start);
+    lock_guard<mutex> lock(scheduleMutex);
+    schedule.insert(tr);
+}
+
+void SegmentExecutor::tick(double now) {
+    TrajectoryState state;
+    {
+        lock_guard<mutex> lock(scheduleMutex);
+        if (!schedule.sample(now, state)) {
+            return;
+        }
+    }
+    //mavros runs in its own process, so the setpoints are serialized either way. Reusing the
+    //messages saves filling new ones, roscpp still allocates the serialization buffer
+    if (feedforward) {
+        targetMsg.header.stamp = ros::Time(now);
+        targetMsg.position.x = state.pos[0];
+        targetMsg.position.y = state.pos[1];
+        targetMsg.position.z = state.pos[2];
+        targetMsg.velocity.x = state.vel[0];
+        targetMsg.velocity.y = state.vel[1];
+        targetMsg.velocity.z = state.vel[2];
+        targetMsg.acceleration_or_force.x = state.acc[0];
+        targetMsg.acceleration_or_force.y = state.acc[1];
+        targetMsg.acceleration_or_force.z = state.acc[2];
+        rawSetPointPub.publish(targetMsg);
+    } else {
+        setpointMsg.header.stamp = ros::Time(now);
+        setpointMsg.pose.position.x = state.pos[0];
+        setpointMsg.pose.position.y = state.pos[1];
+        setpointMsg.pose.position.z = state.pos[2];
+        posSetPointPub.publish(setpointMsg);
+    }
+}
@@ -0,0 +1,41 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <memory>
+#include "SegmentExecutor.h"
+#include "SetpointLoop.h"
+
+namespace swarmsim {
+
+/**
+ * The SegmentExecutor of one drone as a nodelet. Loaded into the manager of the swarm, the
+ * horizons reach it as shared pointers. Takes the params of swarmsim_segment_executor.
+ */
+class SegmentExecutorNodelet : public nodelet::Nodelet {
+private:
+    std::unique_ptr<SegmentExecutor> executor;
+    //declared after the executor so it stops before the executor goes away
+    std::unique_ptr<SetpointLoop> loop;
+
+    void onInit() override {
+        ros::NodeHandle &pnh = getPrivateNodeHandle();
+        int droneId, cpu, priority;
+        double rate;
+        bool feedforward;
+        pnh.param("droneId", droneId, 0);
+        pnh.param("rate", rate, 100.0);
+        pnh.param("feedforward", feedforward, false);
+        pnh.param("cpu", cpu, -1);
+        pnh.param("priority", priority, 0);
+
+        executor.reset(new SegmentExecutor(droneId, getNodeHandle(), feedforward));
+        SegmentExecutor *executor_ = executor.get();
+        loop.reset(new SetpointLoop(rate, [executor_]() {
+            executor_->tick(ros::Time::now().toSec());
+        }, cpu, priority));
+        loop->start();
+    }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(swarmsim::SegmentExecutorNodelet, nodelet::Nodelet)
@@ -0,0 +1,188 @@
+#include "SegmentedTrajectory.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const int HEADER_SIZE = 3;
+    const int SEGMENT_SIZE = 13;
+
+    /**
+     * velocity of sample k, estimated from the neighbouring samples if tr carries none
+     */
+    Eigen::Vector3d sampleVelocity(const Trajectory &tr, int k, double sampleRate) {
+        if (k < (int) tr.vel.size()) {
+            return tr.vel[k];
+        }
+        int last = tr.pos.size() - 1;
+        if (last < 1) {
+            return Eigen::Vector3d::Zero();
+        }
+        int a = max(k - 1, 0);
+        int b = min(k + 1, last);
+        return (tr.pos[b] - tr.pos[a]) * sampleRate / (b - a);
+    }
+
+    PolynomialSegment hermite(const Eigen::Vector3d &p0, const Eigen::Vector3d &v0, const Eigen::Vector3d &p1,
+                              const Eigen::Vector3d &v1, double duration) {
+        PolynomialSegment seg;
+        seg.duration = duration;
+        double T = duration;
+        for (int axis = 0; axis < 3; axis++) {
+            seg.coeffs[axis][0] = p0[axis];
+            seg.coeffs[axis][1] = v0[axis];
+            seg.coeffs[axis][2] = T > 0 ? (3 * (p1[axis] - p0[axis]) - (2 * v0[axis] + v1[axis]) * T) / (T * T) : 0;
+            seg.coeffs[axis][3] = T > 0 ? (2 * (p0[axis] - p1[axis]) + (v0[axis] + v1[axis]) * T) / (T * T * T) : 0;
+        }
+        return seg;
+    }
+
+    PolynomialSegment fitSpan(const Trajectory &tr, int i, int j, double sampleRate) {
+        return hermite(tr.pos[i], sampleVelocity(tr, i, sampleRate), tr.pos[j], sampleVelocity(tr, j, sampleRate),
+                       (j - i) / sampleRate);
+    }
+
+    bool withinTolerance(const Trajectory &tr, int i, int j, double sampleRate, double tolerance) {
+        PolynomialSegment seg = fitSpan(tr, i, j, sampleRate);
+        for (int k = i + 1; k < j; k++) {
+            if ((seg.evaluate((k - i) / sampleRate).pos - tr.pos[k]).norm() > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TrajectoryState PolynomialSegment::evaluate(double t) const {
+    TrajectoryState s;
+    for (int axis = 0; axis < 3; axis++) {
+        const double *c = coeffs[axis];
+        s.pos[axis] = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+        s.vel[axis] = c[1] + t * (2 * c[2] + t * 3 * c[3]);
+        s.acc[axis] = 2 * c[2] + 6 * c[3] * t;
+    }
+    return s;
+}
+
+SegmentedTrajectory::SegmentedTrajectory() : trajectoryId(0), start(0) {}
+
+SegmentedTrajectory SegmentedTrajectory::fit(const Trajectory &tr, double sampleRate, double tolerance,
+                                             const Eigen::Vector3d &offset) {
+    SegmentedTrajectory segmented;
+    int last = tr.pos.size() - 1;
+    if (last == 0) {
+        segmented.segments.push_back(hermite(tr.pos[0], Eigen::Vector3d::Zero(), tr.pos[0],
+                                             Eigen::Vector3d::Zero(), 0));
+    }
+    for (int i = 0; i < last;) {
+        //grow the span geometrically while it fits, then bisect between the last fit and the first miss
+        int good = 1;
+        int bad = -1;
+        for (int span = 2; good < last - i; span *= 2) {
+            span = min(span, last - i);
+            if (!withinTolerance(tr, i, i + span, sampleRate, tolerance)) {
+                bad = span;
+                break;
+            }
+            good = span;
+        }
+        while (bad > 0 && bad - good > 1) {
+            int mid = (good + bad) / 2;
+            if (withinTolerance(tr, i, i + mid, sampleRate, tolerance)) {
+                good = mid;
+            } else {
+                bad = mid;
+            }
+        }
+        segmented.segments.push_back(fitSpan(tr, i, i + good, sampleRate));
+        i += good;
+    }
+    for (PolynomialSegment &seg : segmented.segments) {
+        for (int axis = 0; axis < 3; axis++) {
+            seg.coeffs[axis][0] += offset[axis];
+        }
+    }
+    segmented.index();
+    return segmented;
+}
+
+double SegmentedTrajectory::getDuration() const {
+    return segments.empty() ? 0 : offsets.back() + segments.back().duration;
+}
+
+TrajectoryState SegmentedTrajectory::evaluate(double t) const {
+    if (segments.empty()) {
+        TrajectoryState s;
+        s.pos = s.vel = s.acc = Eigen::Vector3d::Zero();
+        return s;
+    }
+    t = min(max(t, 0.0), getDuration());
+    int idx = upper_bound(offsets.begin(), offsets.end(), t) - offsets.begin() - 1;
+    idx = max(idx, 0);
+    return segments[idx].evaluate(t - offsets[idx]);
+}
+
+void SegmentedTrajectory::encode(vector<double> &out) const {
+    out.clear();
+    out.reserve(HEADER_SIZE + SEGMENT_SIZE * segments.size());
+    out.push_back(trajectoryId);
+    out.push_back(start);
+    out.push_back(segments.size());
+    for (const PolynomialSegment &seg : segments) {
+        out.push_back(seg.duration);
+        for (int axis = 0; axis < 3; axis++) {
+            out.insert(out.end(), seg.coeffs[axis], seg.coeffs[axis] + 4);
+        }
+    }
+}
+
+bool SegmentedTrajectory::decode(const vector<double> &in, SegmentedTrajectory &tr) {
+    if (in.size() < HEADER_SIZE || in[2] < 0 || in.size() != HEADER_SIZE + SEGMENT_SIZE * (size_t) in[2]) {
+        return false;
+    }
+    tr.trajectoryId = (int) in[0];
+    tr.start = in[1];
+    tr.segments.resize((size_t) in[2]);
+    const double *p = in.data() + HEADER_SIZE;
+    for (PolynomialSegment &seg : tr.segments) {
+        seg.duration = *p++;
+        if (!(seg.duration >= 0)) {
+            return false;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            copy(p, p + 4, seg.coeffs[axis]);
+            p += 4;
+        }
+    }
+    tr.index();
+    return true;
+}
+
+void SegmentedTrajectory::index() {
+    offsets.resize(segments.size());
+    double t = 0;
+    for (size_t i = 0; i < segments.size(); i++) {
+        offsets[i] = t;
+        t += segments[i].duration;
+    }
+}
+
+void SegmentSchedule::insert(const SegmentedTrajectory &tr) {
+    horizons[tr.trajectoryId] = tr;
+}
+
+bool SegmentSchedule::sample(double now, TrajectoryState &state) {
+    auto current = horizons.end();
+    for (auto it = horizons.begin(); it != horizons.end() && it->second.start <= now; ++it) {
+        current = it;
+    }
+    if (current == horizons.end()) {
+        return false;
+    }
+    horizons.erase(horizons.begin(), current);
+    state = current->second.evaluate(now - current->second.start);
+    return true;
+}
+
+size_t SegmentSchedule::size() const {
+    return horizons.size();
+}
@@ -0,0 +1,124 @@
+#include "SetpointLoop.h"
+#include <ros/console.h>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+namespace {
+    const int64_t NS_PER_S = 1000000000;
+
+    int64_t toNs(const timespec &t) {
+        return t.tv_sec * NS_PER_S + t.tv_nsec;
+    }
+
+    timespec fromNs(int64_t ns) {
+        timespec t;
+        t.tv_sec = ns / NS_PER_S;
+        t.tv_nsec = ns % NS_PER_S;
+        return t;
+    }
+
+    int64_t monotonicNow() {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return toNs(now);
+    }
+}
+
+SetpointLoop::SetpointLoop(double rate, function<void()> tick, int cpu, int priority)
+        : tick(move(tick)), cpu(cpu), priority(priority), stopped(true), ticks(0), overruns(0), totalLatenessNs(0),
+          maxLatenessNs(0) {
+    if (rate <= 0) {
+        throw runtime_error("The setpoint rate must be positive");
+    }
+    periodNs = (int64_t) (NS_PER_S / rate);
+}
+
+SetpointLoop::~SetpointLoop() {
+    stop();
+}
+
+void SetpointLoop::start() {
+    if (loop.joinable()) {
+        return;
+    }
+    stopped = false;
+    loop = thread(&SetpointLoop::run, this);
+}
+
+void SetpointLoop::stop() {
+    stopped = true;
+    if (loop.joinable()) {
+        loop.join();
+    }
+}
+
+LoopStats SetpointLoop::getStats() {
+    LoopStats stats;
+    stats.ticks = ticks.exchange(0);
+    stats.overruns = overruns.exchange(0);
+    uint64_t total = totalLatenessNs.exchange(0);
+    stats.meanLateness = stats.ticks > 0 ? total / 1e9 / stats.ticks : 0;
+    stats.maxLateness = maxLatenessNs.exchange(0) / 1e9;
+    return stats;
+}
+
+string SetpointLoop::report() {
+    LoopStats stats = getStats();
+    ostringstream ss;
+    ss.precision(3);
+    ss << stats.ticks << " ticks, " << stats.overruns << " overruns, lateness " << stats.meanLateness * 1e3
+       << " ms (max " << stats.maxLateness * 1e3 << " ms)";
+    return ss.str();
+}
+
+void SetpointLoop::run() {
+    configureThread();
+    int64_t deadline = monotonicNow();
+    while (!stopped) {
+        deadline += periodNs;
+        timespec wake = fromNs(deadline);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {}
+        if (stopped) {
+            break;
+        }
+        uint64_t lateness = max<int64_t>(monotonicNow() - deadline, 0);
+        tick();
+        ticks++;
+        totalLatenessNs += lateness;
+        uint64_t cur = maxLatenessNs.load(memory_order_relaxed);
+        while (lateness > cur && !maxLatenessNs.compare_exchange_weak(cur, lateness, memory_order_relaxed)) {}
+
+        //skip the deadlines that already passed instead of running the ticks back to back
+        int64_t missed = (monotonicNow() - deadline) / periodNs;
+        if (missed > 0) {
+            overruns += missed;
+            deadline += missed * periodNs;
+        }
+    }
+}
+
+void SetpointLoop::configureThread() {
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0) {
+            ROS_WARN_STREAM("Failed to pin the setpoint thread to cpu " << cpu << ": " << strerror(err));
+        }
+    }
+    if (priority > 0) {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            ROS_WARN_STREAM("Failed to run the setpoint thread as SCHED_FIFO " << priority << ": " << strerror(err));
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#include "SetpointTick.h"
+
+SetpointTick::SetpointTick() : feedforward(false), segmentExecution(false) {
+    //mavros converts the local frame to NED itself, the setpoints stay in ENU
+    targetMsg.coordinate_frame = mavros_msgs::PositionTarget::FRAME_LOCAL_NED;
+}
+
+bool SetpointTick::update(TrajectoryQueue &queue, double now, double sampleRate, const Eigen::Vector3d &home,
+                          const ros::Time &stamp) {
+    bool active = queue.sample(now, sampleRate, reference);
+    const Trajectory &trajectory = *queue.getCurrent();
+    waypoint = reference.pos - home;
+    if (segmentExecution) {
+        return active;
+    }
+    if (feedforward) {
+        //the yaw is left to the autopilot as for the position setpoints. Waypoint
+        //trajectories carry no derivatives, a zero velocity would brake the drone
+        targetMsg.type_mask = mavros_msgs::PositionTarget::IGNORE_YAW | mavros_msgs::PositionTarget::IGNORE_YAW_RATE;
+        if (trajectory.vel.empty()) {
+            targetMsg.type_mask |= mavros_msgs::PositionTarget::IGNORE_VX | mavros_msgs::PositionTarget::IGNORE_VY
+                                   | mavros_msgs::PositionTarget::IGNORE_VZ;
+        }
+        if (trajectory.acc.empty()) {
+            targetMsg.type_mask |= mavros_msgs::PositionTarget::IGNORE_AFX | mavros_msgs::PositionTarget::IGNORE_AFY
+                                   | mavros_msgs::PositionTarget::IGNORE_AFZ;
+        }
+        targetMsg.header.stamp = stamp;
+        targetMsg.position.x = waypoint[0];
+        targetMsg.position.y = waypoint[1];
+        targetMsg.position.z = waypoint[2];
+        targetMsg.velocity.x = reference.vel[0];
+        targetMsg.velocity.y = reference.vel[1];
+        targetMsg.velocity.z = reference.vel[2];
+        targetMsg.acceleration_or_force.x = reference.acc[0];
+        targetMsg.acceleration_or_force.y = reference.acc[1];
+        targetMsg.acceleration_or_force.z = reference.acc[2];
+    } else {
+        setpointMsg.pose.position.x = waypoint[0];
+        setpointMsg.pose.position.y = waypoint[1];
+        setpointMsg.pose.position.z = waypoint[2];
+    }
+    return active;
+}
@@ -8,52 +8,69 @@ SimplePlanningPhase::SimplePlanningPhase(int nDrones, double frequency, string y
     this->yamlFpath = move(yamlFpath);
 }
 
-void SimplePlanningPhase::doPlanning(int horizonId, std::vector<Trajectory> prevPlan) {
-    auto sharedP = make_shared<promise<vector<Trajectory> > >();
+SimplePlanningPhase::~SimplePlanningPhase() {
+    stopSpeculation();
+}
+
+void SimplePlanningPhase::doPlanning(int horizonId, std::vector<TrajectoryPtr> prevPlan,
+                                     vector<Eigen::Vector3d> expectedStart) {
+    //the previous planning thread may still be planning ahead. It is told to stop and joined by the
+    //new thread before it reuses the members, so the supervisory timer does not wait for its solver
+    int round = ++planningRound;
+    thread *previous = planning_t;
+    auto sharedP = make_shared<promise<vector<TrajectoryPtr> > >();
     fut = sharedP->get_future();
-    auto doPlanningExpr = [horizonId, this, sharedP, prevPlan]() {
+    auto doPlanningExpr = [horizonId, this, sharedP, prevPlan, expectedStart, previous, round]() {
+        if (previous != nullptr) {
+            previous->join();
+            delete previous;
+        }
         try {
             discreteWpts = this->getDiscretePlan(horizonId);
         }
         catch (range_error &e) {
-            ROS_ERROR_STREAM("Error occurred while planning!");
+            ROS_ERROR_STREAM("Error occurred while planning! " << e.what());
+            //getPlanningResults hands over no plan instead of a broken promise
+            sharedP->set_exception(current_exception());
             return;
         }
-        bool initialQP;
-        bool lastQP;
-        horizonId == 0 ? initialQP = true : initialQP = false;
-        horizonId == nHorizons ? lastQP = true : lastQP = false;
-        vector<Trajectory> smoothTrajs = computeSmoothTrajectories(initialQP, lastQP, prevPlan);
+        if (applyWaypointUpdates(discreteWpts)) {
+            //the speculative plans were chained on the old subgoals
+            invalidateSpeculativePlans(horizonId);
+        }
+        vector<TrajectoryPtr> smoothTrajs;
+        if (takeSpeculativePlan(horizonId, expectedStart, smoothTrajs)) {
+            ROS_DEBUG_STREAM("Using the speculative plan for horizon " << horizonId);
+        } else {
+            smoothTrajs = computeSmoothTrajectories(isInitialHorizon(horizonId), isLastHorizon(horizonId), prevPlan);
+        }
         try {
-            sharedP->set_value_at_thread_exit(smoothTrajs);
+            sharedP->set_value(smoothTrajs);
         }
         catch (std::future_error &e) {
             ROS_ERROR_STREAM("Caught a future_error while fulfilling the promise\"" << e.what());
         }
         doneInitPlanning = true;
+        speculate(horizonId + 1, smoothTrajs, round);
     };
     planning_t = new thread(doPlanningExpr);
 }
 
 vector<Trajectory> SimplePlanningPhase::getDiscretePlan(int horizonId) {
-    ROS_DEBUG_STREAM("YAML file path: " << yamlFpath);
-    char cstr[yamlFpath.size() + 1];
-    copy(yamlFpath.begin(), yamlFpath.end(), cstr);
-    cstr[yamlFpath.size()] = '\0';
     vector<Trajectory> planningResults;
-    bool initPlan = horizonId == 0;
     try {
-        if(initPlan) {
-            simutils::processYamlFile(cstr, yamlDescriptor);
+        if (mission == nullptr) {
+            ROS_DEBUG_STREAM("YAML file path: " << yamlFpath);
+            mission.reset(new IndexedMission(yamlFpath, lookahead));
+            nHorizons = mission->getHorizons();
         }
-        ROS_DEBUG_STREAM("getTimesArray: "<<yamlDescriptor.getTimesArray()[1].times.size());
-        planningResults = simutils::getHorizonTrajetories(horizonId, yamlDescriptor);
-        nHorizons = yamlDescriptor.getHorizons();
+        planningResults = mission->getHorizon(horizonId);
         ROS_DEBUG_STREAM("planningResults: "<<planningResults.size());
     }
-    catch (range_error &e) {
+    catch (runtime_error &e) {
+        //malformed mission files are reported the same way as running past the last horizon
         ROS_WARN_STREAM(e.what() << " " << horizonId);
         throw range_error(e.what());
     }
     return planningResults;
-}
\ No newline at end of file
+}
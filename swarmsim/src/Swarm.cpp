@@ -3,18 +3,26 @@
 #include "Swarm.h"
 #include "state.h"
 #include <thread>
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
+#include <cstdio>
+#include <iomanip>
 #include <std_msgs/Int8.h>
+#include <boost/bind.hpp>
 
 using namespace std;
 
 Swarm::Swarm(const ros::NodeHandle &n, double frequency, int n_drones, string& trajDir, 
         bool visualizeTraj, string& obstacleFileName)
         : frequency(frequency), n_drones(n_drones), nh(n), visualizeTraj(visualizeTraj) {
+    //loaded before the drones are created, a malformed file throws before anything needs cleaning up
+    vector<TrajectoryPtr> trajectories;
+    for (Trajectory &traj : simutils::loadTrajectoriesFromFile(n_drones, trajDir)) {
+        trajectories.push_back(make_shared<const Trajectory>(move(traj)));
+    }
     initVariables();
     predefined = true;
-    vector<Trajectory> trajectories = simutils::loadTrajectoriesFromFile(n_drones, nh, trajDir);
     if(visualizeTraj) {
         ROS_DEBUG_STREAM("Visualizing the trajectories");
         stringstream ss;
@@ -24,10 +32,10 @@ Swarm::Swarm(const ros::NodeHandle &n, double frequency, int n_drones, string& t
         vis->addToPaths(trajectories);
     }
     for (int i = 0; i < n_drones; i++) {
-        Trajectory traj = trajectories[i];
-        dronesList[i]->pushTrajectory(traj);
+        dronesList[i]->pushTrajectory(trajectories[i]);
     }
-    swarmStatePub = nh.advertise<std_msgs::Int8>("swarm/state", 100, false);
+    publishPlan(0, trajectories);
+    swarmStatePub = nh.advertise<std_msgs::Int8>("swarm/state", 100, true);
 }
 
 Swarm::Swarm(const ros::NodeHandle &n, double frequency, int n_drones, string& trajDir, string& yamlFileName, 
@@ -39,7 +47,8 @@ Swarm::Swarm(const ros::NodeHandle &n, double frequency, int n_drones, string& t
         string yamlFilePath = s1.str();
         s2 << trajDir << obstacleFileName;
         string obstacleConfigPath = s2.str();
-        swarmStatePub = nh.advertise<std_msgs::Int8>("swarm/state", 100, false);
+        missionPath = yamlFilePath;
+        swarmStatePub = nh.advertise<std_msgs::Int8>("swarm/state", 100, true);
         executionInitialized = false;
 
     try {
@@ -48,23 +57,75 @@ Swarm::Swarm(const ros::NodeHandle &n, double frequency, int n_drones, string& t
         }
         initVariables();
         planningPhase = new SimplePlanningPhase(n_drones, frequency, yamlFilePath);
-        planningPhase->doPlanning(horizonId++, prevTrl);
-        vector<Trajectory> trl = planningPhase->getPlanningResults();
-        ROS_DEBUG_STREAM("Retrieved the initial planning results. Size: " << trl[0].pos.size());
-        horizonLen = trl[0].pos.size();
-        for (int i = 0; i < n_drones; i++) {
-            dronesList[i]->pushTrajectory(trl[i]);
+        nh.param("lookahead", planningPhase->lookahead, 0);
+        nh.param("speculationThreshold", planningPhase->speculationThreshold, 0.1);
+        nh.param("partitionCellSize", planningPhase->partitionCellSize, 10.0);
+        nh.param("minSeparation", planningPhase->minSeparation, 0.5);
+        nh.param<string>("checkpoint", checkpointPath, "");
+        nh.param("checkpointPeriod", checkpointPeriod, 1.0);
+        ROS_DEBUG_STREAM("Planning lookahead: " << planningPhase->lookahead << " horizons");
+        if (!resumeFromCheckpoint()) {
+            planningPhase->doPlanning(horizonId++, prevTrl, vector<Eigen::Vector3d>());
+            vector<TrajectoryPtr> trl = planningPhase->getPlanningResults();
+            if ((int) trl.size() != n_drones) {
+                throw runtime_error("The first horizon could not be planned");
+            }
+            ROS_DEBUG_STREAM("Retrieved the initial planning results. Size: " << trl[0]->pos.size());
+            horizonLen = trl[0]->pos.size();
+            for (int i = 0; i < n_drones; i++) {
+                dronesList[i]->pushTrajectory(trl[i]);
+            }
+            publishPlan(0, trl);
+            this->prevTrl = move(trl);
         }
-        this->prevTrl = trl;
+        initWaypointStreams();
     }
     catch (const length_error &le) {
         ROS_ERROR_STREAM("Error in retrieving the results from the future");
-        return;
+        loaded = false;
     }
     catch (const runtime_error &re) {
         ROS_ERROR_STREAM("Error initializing the swarm. "<<re.what());
-        return;
+        loaded = false;
+    }
+}
+
+Swarm::Swarm(const ros::NodeHandle &n, double frequency, shared_ptr<CompiledMission> mission, bool visualizeTraj)
+        : nh(n), frequency(frequency), n_drones(mission->getDrones()), visualizeTraj(visualizeTraj),
+          compiledMission(move(mission)) {
+    initVariables();
+    predefined = true;
+    if (compiledMission->getFrequency() != frequency) {
+        ROS_WARN_STREAM("The mission was compiled for " << compiledMission->getFrequency() << "Hz but the swarm runs at "
+                                                        << frequency << "Hz");
+    }
+    if (visualizeTraj) {
+        vis = new Visualize(n, "map", this->n_drones, compiledMission->getObstacles());
     }
+    pushCompiledHorizon();
+    swarmStatePub = nh.advertise<std_msgs::Int8>("swarm/state", 100, true);
+}
+
+Swarm::~Swarm() {
+    stop();
+    //the calls in flight use the service clients of the drones, the dispatcher joins them first.
+    //The drones only dispatch from the loops stopped above
+    dispatcher.reset();
+    //their subscriptions are bound to the shard queues, so they go before the shards
+    for (Drone *drone : dronesList) {
+        delete drone;
+    }
+    dronesList.clear();
+    callbackShards.reset();
+    if (spliceFut.valid()) {
+        //the splice solver reads the limits of the planning phase
+        spliceFut.wait();
+    }
+    if (planningPhase != nullptr) {
+        planningPhase->shutdown();
+        delete planningPhase;
+    }
+    delete vis;
 }
 
 void Swarm::initVariables() {
@@ -73,40 +134,283 @@ void Swarm::initVariables() {
     phase = Phases::Planning;
     horizonId = 0;
     planningInitialized = false;
+    splicePending = false;
+    compiledHorizons = 0;
+    lastCheckpoint = 0;
+    lastMemoryReport = 0;
+    setpointProgress = 0;
+    phaseTrajectoryId = 0;
+    nh.param("memoryReportPeriod", memoryReportPeriod, 0.0);
+    nh.param("cpuReportPeriod", cpuReportPeriod, 0.0);
+    vector<string> cpuProcesses;
+    nh.param("cpuProcesses", cpuProcesses, vector<string>());
+    cpuUsage = CpuUsage(cpuProcesses);
+    double stateHeartbeatPeriod;
+    nh.param("stateHeartbeatPeriod", stateHeartbeatPeriod, 1.0);
+    stateHeartbeat = Heartbeat(stateHeartbeatPeriod);
+    lastCpuReport = 0;
+    int commandThreads, commandAttempts;
+    double commandRetryDelay;
+    nh.param("commandThreads", commandThreads, 8);
+    nh.param("commandAttempts", commandAttempts, 3);
+    nh.param("commandRetryDelay", commandRetryDelay, 0.5);
+    dispatcher.reset(new CommandDispatcher(n_drones, commandThreads, commandAttempts, commandRetryDelay));
+    int callbackThreads;
+    nh.param("callbackThreads", callbackThreads, 4);
+    nh.param("callbackReportPeriod", callbackReportPeriod, 0.0);
+    lastCallbackReport = 0;
+    if (callbackThreads > 0) {
+        callbackShards.reset(new CallbackShards(min(callbackThreads, n_drones)));
+    }
+    //a drone registers its topics and services with the master, construct them side by side
+    dronesList.assign(n_drones, nullptr);
+    int nBuilders = min<int>(n_drones, max(1u, thread::hardware_concurrency()));
+    vector<future<void> > builders;
+    for (int t = 0; t < nBuilders; t++) {
+        builders.push_back(async(launch::async, [this, t, nBuilders]() {
+            for (int i = t; i < n_drones; i += nBuilders) {
+                dronesList[i] = new Drone(i, nh, dispatcher.get(),
+                                          callbackShards ? callbackShards->getQueue(i) : nullptr, &stateCounters);
+            }
+        }));
+    }
+    for (future<void> &builder : builders) {
+        builder.get();
+    }
+    nh.param("feedforward", feedforward, false);
+    nh.param("trackingReportPeriod", trackingReportPeriod, 0.0);
+    lastTrackingReport = 0;
+    double segmentTolerance;
+    nh.param("segmentExecution", segmentExecution, false);
+    nh.param("segmentTolerance", segmentTolerance, 0.01);
+    for (Drone *drone : dronesList) {
+        drone->setFeedforward(feedforward);
+        drone->setSegmentExecution(segmentExecution, segmentTolerance);
+    }
+    if (callbackShards) {
+        callbackShards->start();
+    }
+    initModelStates();
+    initRecorder();
+    initRegistry();
+}
+
+void Swarm::initModelStates() {
+    indexedModels = 0;
     for (int i = 0; i < n_drones; i++) {
-        Drone *drone = new Drone(i, nh);
-        dronesList.push_back(drone);
+        stringstream ss;
+        ss << "iris_" << i;
+        modelIds[ss.str()] = i;
     }
+    modelStatesSub = nh.subscribe("/gazebo/model_states", 10, &Swarm::modelStatesCB, this);
+    ros::topic::waitForMessage<gazebo_msgs::ModelStates>("/gazebo/model_states", ros::Duration(5));
 }
 
-void Swarm::iteration(const ros::TimerEvent &e) {
-    if(this->visualizeTraj) {
-        vis->draw();
-        for(int i=0; i<n_drones;i++) {
-            dronesList[i]->publishGlobalPose();
+void Swarm::modelStatesCB(const gazebo_msgs::ModelStatesConstPtr &msg) {
+    //the model order only changes when models are spawned or deleted
+    if (msg->name.size() != indexedModels) {
+        modelIndex.assign(n_drones, -1);
+        for (size_t i = 0; i < msg->name.size(); i++) {
+            auto it = modelIds.find(msg->name[i]);
+            if (it != modelIds.end()) {
+                modelIndex[it->second] = i;
+            }
+        }
+        indexedModels = msg->name.size();
+    }
+    bool waiting = false;
+    for (int i = 0; i < n_drones; i++) {
+        if (modelIndex[i] >= 0) {
+            dronesList[i]->setGazeboPose(msg->pose[modelIndex[i]]);
         }
+        waiting = waiting || !dronesList[i]->hasHome();
+    }
+    if (!waiting) {
+        ROS_DEBUG_STREAM("Recorded the home of every drone");
+        modelStatesSub.shutdown();
+    }
+}
+
+void Swarm::initRecorder() {
+    string flightLog;
+    nh.param<string>("flightLog", flightLog, "");
+    if (flightLog.empty()) {
+        return;
+    }
+    try {
+        recorder.reset(new FlightRecorder(flightLog));
+    }
+    catch (runtime_error &e) {
+        ROS_ERROR_STREAM("Flying without a flight recorder. " << e.what());
+        return;
+    }
+    for (Drone *drone : dronesList) {
+        drone->setRecorder(recorder.get());
+    }
+}
+
+void Swarm::initRegistry() {
+    string registryName;
+    double capacity;
+    nh.param<string>("trajectoryRegistry", registryName, "");
+    nh.param("registryCapacity", capacity, 60.0);
+    if (registryName.empty()) {
+        return;
+    }
+    try {
+        registry.reset(new TrajectoryRegistry(registryName, n_drones, (int) ceil(capacity * frequency), frequency));
+    }
+    catch (runtime_error &e) {
+        ROS_ERROR_STREAM("Flying without a trajectory registry. " << e.what());
+    }
+}
+
+void Swarm::publishPlan(int horizonId, const vector<TrajectoryPtr> &plan) {
+    if (registry) {
+        registry->publish(horizonId, plan);
+    }
+}
+
+void Swarm::recordPlanningEvent(PlanningEvent event, int horizonId) {
+    if (recorder) {
+        recorder->recordPlanningEvent(ros::Time::now().toSec(), event, horizonId);
+    }
+}
+
+bool Swarm::resumeFromCheckpoint() {
+    if (checkpointPath.empty()) {
+        return false;
+    }
+    SwarmCheckpoint checkpoint;
+    try {
+        checkpoint = MissionCheckpoint::read(checkpointPath);
+    }
+    catch (runtime_error &e) {
+        ROS_INFO_STREAM("Starting the mission from the first horizon. " << e.what());
+        return false;
+    }
+    if (checkpoint.mission != missionPath || (int) checkpoint.drones.size() != n_drones) {
+        ROS_WARN_STREAM("The checkpoint " << checkpointPath << " belongs to another mission. Ignored");
+        return false;
+    }
+    for (int i = 0; i < n_drones; i++) {
+        dronesList[i]->restore(checkpoint.drones[i]);
+        prevTrl.push_back(checkpoint.drones[i].trajectories.back());
+    }
+    horizonId = checkpoint.horizonId;
+    planningPhase->nHorizons = checkpoint.nHorizons;
+    horizonLen = prevTrl[0]->pos.size();
+    publishPlan(horizonId - 1, prevTrl);
+    //a horizon queued behind the current one is already planned, so the next planning
+    //phase starts with the drones on it. Otherwise the current horizon still needs its successor
+    bool planned = checkpoint.drones[0].trajectories.size() > 1 || horizonId >= checkpoint.nHorizons;
+    planningInitialized = planned;
+    executionInitialized = planned;
+    phaseTrajectoryId = checkpoint.drones.back().trajectoryId;
+    setpointProgress = ((uint64_t) phaseTrajectoryId << 32) | (uint32_t) checkpoint.drones.back().execPointer;
+    ROS_INFO_STREAM("Resumed the mission at horizon " << checkpoint.drones[0].trajectoryId << ", sample "
+                                                      << checkpoint.drones[0].execPointer);
+    return true;
+}
+
+void Swarm::saveCheckpoint(double stamp) {
+    if (checkpointPath.empty()
+        || (checkpointFut.valid() && checkpointFut.wait_for(chrono::seconds(0)) != future_status::ready)) {
+        return;
+    }
+    lastCheckpoint = stamp;
+    SwarmCheckpoint checkpoint;
+    checkpoint.mission = missionPath;
+    checkpoint.nHorizons = planningPhase->nHorizons;
+    for (int i = 0; i < n_drones; i++) {
+        checkpoint.drones.push_back(dronesList[i]->getCheckpoint());
+    }
+    //the horizons are pushed in order, so the next one to plan follows the last queued one
+    checkpoint.horizonId = checkpoint.drones[0].trajectoryId + checkpoint.drones[0].trajectories.size();
+    string fPath = checkpointPath;
+    checkpointFut = async(launch::async, [fPath, checkpoint]() {
+        try {
+            MissionCheckpoint::write(fPath, checkpoint);
+        }
+        catch (runtime_error &e) {
+            ROS_WARN_STREAM(e.what());
+        }
+    });
+}
+
+void Swarm::clearCheckpoint() {
+    if (checkpointPath.empty()) {
+        return;
+    }
+    if (checkpointFut.valid()) {
+        checkpointFut.wait();
+    }
+    remove(checkpointPath.c_str());
+    ROS_DEBUG_STREAM("Mission complete. Removed the checkpoint " << checkpointPath);
+}
+
+void Swarm::iteration(const ros::TimerEvent &e) {
+    if (recorder) {
+        recorder->recordState(e.current_real.toSec(), state);
+    }
+    if (memoryReportPeriod > 0 && e.current_real.toSec() - lastMemoryReport >= memoryReportPeriod) {
+        ROS_INFO_STREAM("Live memory. " << MemoryAccounting::report());
+        lastMemoryReport = e.current_real.toSec();
+    }
+    if (callbackShards && callbackReportPeriod > 0
+        && e.current_real.toSec() - lastCallbackReport >= callbackReportPeriod) {
+        ROS_INFO_STREAM("Callback queues. " << callbackShards->report());
+        lastCallbackReport = e.current_real.toSec();
+    }
+    if (cpuReportPeriod > 0 && e.current_real.toSec() - lastCpuReport >= cpuReportPeriod) {
+        double usage = cpuUsage.sample() * 100;
+        //planning runs in this process as well, so the total is not split across the drones
+        ROS_INFO_STREAM("CPU " << usage << "% over " << cpuUsage.getProcesses() << " processes");
+        lastCpuReport = e.current_real.toSec();
+    }
+    if (setpointLoop && setpointReportPeriod > 0
+        && e.current_real.toSec() - lastSetpointReport >= setpointReportPeriod) {
+        ROS_INFO_STREAM("Setpoint loop. " << setpointLoop->report());
+        lastSetpointReport = e.current_real.toSec();
+    }
+    if (trackingReportPeriod > 0 && e.current_real.toSec() - lastTrackingReport >= trackingReportPeriod) {
+        ROS_INFO_STREAM("Tracking error. " << trackingReport());
+        lastTrackingReport = e.current_real.toSec();
+    }
+    if (stateHeartbeat.due(e.current_real.toSec())) {
+        publishState(e.current_real.toSec());
+    }
+    for (Drone *drone : dronesList) {
+        drone->updatePose();
     }
     switch (state) {
         case States::Idle:
-            checkSwarmForStates(States::Ready);
+            checkSwarmForStates(States::Ready, e.current_real.toSec());
             break;
 
         case States::Ready:
             armDrones(true);
-            checkSwarmForStates(States::Armed);
+            checkSwarmForStates(States::Armed, e.current_real.toSec());
             break;
 
         case States::Armed:
             TOLService(true);
-            checkSwarmForStates(States::Autonomous);
+            checkSwarmForStates(States::Autonomous, e.current_real.toSec());
             break;
 
         case States::Autonomous:
+            TOLService(true);
             if (!predefined) {
-                performPhaseTasks();
+                setSwarmPhase();
+                performPhaseTasks(e.current_real.toSec());
+                performSpliceTasks();
+                if (e.current_real.toSec() - lastCheckpoint >= checkpointPeriod) {
+                    saveCheckpoint(e.current_real.toSec());
+                }
+            } else if (compiledMission) {
+                performCompiledTasks();
             }
-            sendPositionSetPoints();
-            checkSwarmForStates(States::Reached);
+            checkSwarmForStates(States::Reached, e.current_real.toSec());
             break;
 
         case States::Reached:
@@ -118,32 +422,167 @@ void Swarm::iteration(const ros::TimerEvent &e) {
     }
 }
 
-void Swarm::run(float frequency_) {
+void Swarm::visualize(const ros::TimerEvent &e) {
+    vis->draw();
+    for (int i = 0; i < n_drones; i++) {
+        dronesList[i]->publishGlobalPose();
+    }
+}
+
+void Swarm::start(float frequency_) {
     this->frequency = frequency_;
-    ros::Timer timer = nh.createTimer(ros::Duration(1 / frequency),
-                                      &Swarm::iteration, this);
+    double supervisorRate, visualizationRate;
+    double setpointRate;
+    int setpointCpu, setpointPriority;
+    nh.param("supervisorRate", supervisorRate, 20.0);
+    nh.param("visualizationRate", visualizationRate, 10.0);
+    //0 publishes at the sample rate of the trajectories
+    nh.param("setpointRate", setpointRate, 0.0);
+    nh.param("setpointCpu", setpointCpu, -1);
+    nh.param("setpointPriority", setpointPriority, 0);
+    nh.param("setpointReportPeriod", setpointReportPeriod, 0.0);
+    lastSetpointReport = 0;
+
+    if (setpointRate <= 0) {
+        setpointRate = frequency;
+    }
+    //the setpoints are interpolated between the samples, so they may be published faster than the trajectories are sampled
+    setpointLoop.reset(new SetpointLoop(setpointRate, [this]() {
+        if (state == States::Autonomous) {
+            sendPositionSetPoints();
+        }
+    }, setpointCpu, setpointPriority));
+    //latched, so subscribers joining later still get the state of the swarm. The timer events
+    //are stamped with ros::Time::now() as well
+    publishState(ros::Time::now().toSec());
+    supervisorTimer = nh.createTimer(ros::Duration(1 / supervisorRate), &Swarm::iteration, this);
+    if (visualizeTraj) {
+        visTimer = nh.createTimer(ros::Duration(1 / visualizationRate), &Swarm::visualize, this);
+    }
+    setpointLoop->start();
+}
+
+void Swarm::stop() {
+    supervisorTimer.stop();
+    visTimer.stop();
+    if (setpointLoop) {
+        setpointLoop->stop();
+    }
+}
+
+void Swarm::run(float frequency_) {
+    start(frequency_);
     ros::spin();
+    stop();
+}
+
+Swarm *Swarm::create(const ros::NodeHandle &n, double frequency) {
+    int nDrones;
+    bool predefinedTrajectories, visualizeTraj;
+    string yamlFileName, trajDir, obstacleConfigFileName, compiledMissionFileName;
+    n.param("nDrones", nDrones, 1);
+    n.param("predefined", predefinedTrajectories, false);
+    n.param<string>("trajDir", trajDir, "");
+    n.param<string>("yamlFileName", yamlFileName, "");
+    n.param("visualize", visualizeTraj, false);
+    n.param<string>("obstacleFileName", obstacleConfigFileName, "");
+    n.param<string>("compiledMission", compiledMissionFileName, "");
+
+    ROS_DEBUG_STREAM("Number of drones: " << nDrones);
+    ROS_DEBUG_STREAM("Visualize trajectories: " << visualizeTraj);
+    ROS_DEBUG_STREAM("Use predefined trajectories: " << predefinedTrajectories);
+    ROS_DEBUG_STREAM("Trajectory dir: " << trajDir);
+    ROS_DEBUG_STREAM("obstacleConfigFileName: " << obstacleConfigFileName);
+
+    if (!compiledMissionFileName.empty()) {
+        ROS_DEBUG_STREAM("Compiled mission: " << compiledMissionFileName);
+        shared_ptr<CompiledMission> mission;
+        try {
+            mission = make_shared<CompiledMission>(trajDir + compiledMissionFileName);
+        }
+        catch (runtime_error &e) {
+            ROS_ERROR_STREAM("Failed to load the compiled mission. " << e.what());
+            return nullptr;
+        }
+        return new Swarm(n, frequency, mission, visualizeTraj);
+    }
+    if (!predefinedTrajectories) {
+        ROS_DEBUG_STREAM("YAML file name: " << yamlFileName);
+        Swarm *swarm = new Swarm(n, frequency, nDrones, trajDir, yamlFileName, visualizeTraj, obstacleConfigFileName);
+        if (!swarm->isLoaded()) {
+            delete swarm;
+            return nullptr;
+        }
+        return swarm;
+    }
+    try {
+        return new Swarm(n, frequency, nDrones, trajDir, visualizeTraj, obstacleConfigFileName);
+    }
+    catch (runtime_error &e) {
+        ROS_ERROR_STREAM("Failed to load the predefined trajectories. " << e.what());
+        return nullptr;
+    }
 }
 
-void Swarm::setState(int state_) {
+bool Swarm::isLoaded() {
+    return loaded;
+}
+
+void Swarm::setState(int state_, double now) {
+    if (state_ == States::Reached && state != States::Reached) {
+        ROS_INFO_STREAM("Tracking error. " << trackingReport());
+        clearCheckpoint();
+        if (!predefined) {
+            //no horizon is left to plan, release the planning thread and its plans
+            planningPhase->shutdown();
+        }
+    }
+    bool changed = state != state_;
     this->state = state_;
     ROS_DEBUG_STREAM("Set swarm state: " << state);
+    if (changed) {
+        publishState(now);
+    }
 }
 
-void Swarm::checkSwarmForStates(int state_) {
-    bool swarmInState = true;
+vector<Eigen::Vector3d> Swarm::getExpectedStart() {
+    vector<Eigen::Vector3d> expectedStart;
+    for (Drone *drone : dronesList) {
+        expectedStart.push_back(drone->getExpectedEndPosition());
+    }
+    return expectedStart;
+}
+
+string Swarm::trackingReport() {
+    TrackingStats swarm;
+    stringstream ss;
+    ss << fixed << setprecision(3) << (feedforward ? "feedforward" : "position only");
     for (int i = 0; i < n_drones; i++) {
-        bool swarmInStateTemp;
-        dronesList[i]->getState() == state_ ? swarmInStateTemp = true : swarmInStateTemp = false;
-        swarmInState = swarmInState && swarmInStateTemp;
+        TrackingStats drone = dronesList[i]->getTrackingStats();
+        swarm.samples += drone.samples;
+        swarm.sumSq += drone.sumSq;
+        swarm.max = max(swarm.max, drone.max);
+    }
+    if (swarm.samples == 0) {
+        ss << ", no samples";
+        return ss.str();
     }
+    ss << ", rms " << sqrt(swarm.sumSq / swarm.samples) << "m, max " << swarm.max << "m over "
+       << swarm.samples << " setpoints";
+    return ss.str();
+}
 
-    if (swarmInState) {
-        setState(state_);
+void Swarm::checkSwarmForStates(int state_, double now) {
+    if (stateCounters.count(state_) == n_drones) {
+        setState(state_, now);
     }
+}
+
+void Swarm::publishState(double now) {
     std_msgs::Int8 msg;
     msg.data = this->state;
     swarmStatePub.publish(msg);
+    stateHeartbeat.sent(now);
 }
 
 void Swarm::armDrones(bool arm) {
@@ -159,40 +598,49 @@ void Swarm::TOLService(bool takeoff) {
 }
 
 void Swarm::sendPositionSetPoints() {
+    //one timestamp per tick keeps the drones on the same point of their trajectories. The
+    //segment executors run in other processes and only share the ROS clock with the swarm
+    double now = segmentExecution ? ros::Time::now().toSec()
+                                  : chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
     int execPointer = 0;
     for (int i = 0; i < n_drones; i++) {
-        execPointer = this->dronesList[i]->executeTrajectory();
-    }
-    if (!predefined) {
-        setSwarmPhase(execPointer);
+        execPointer = this->dronesList[i]->executeTrajectory(now, frequency);
     }
+    //the supervisory loop derives the swarm phase from the progress of the last drone
+    setpointProgress = ((uint64_t) dronesList.back()->getTrajectoryId() << 32) | (uint32_t) execPointer;
 }
 
 /**
  * todo: change these ratios if one wants to use receding horizon planning.
  * eg: plan again when progress is 0.5 if the execution horizon = 0.5*planning horizon
 */
-void Swarm::setSwarmPhase(int execPointer) {
+void Swarm::setSwarmPhase() {
+    uint64_t setpoint = setpointProgress;
+    int trajectoryId = setpoint >> 32;
+    int execPointer = (uint32_t) setpoint;
     double progress = (double) execPointer / horizonLen;
+    //the drones started on a new horizon since the last tick
+    if (trajectoryId != phaseTrajectoryId) {
+        ROS_DEBUG_STREAM(
+                "Resetting planning and execution flags. exec: " << execPointer << " progress: " << progress);
+        planningInitialized = false;
+        executionInitialized = false;
+        phaseTrajectoryId = trajectoryId;
+    }
     if (progress < planExecutionRatio) {
-        if (progress == 0) {
-            ROS_DEBUG_STREAM(
-                    "Resetting planning and execution flags. exec: " << execPointer << " progress: " << progress);
-            planningInitialized = false;
-            executionInitialized = false;
-        }
         phase = Phases::Planning;
     } else {
         phase = Phases::Execution;
     }
 }
 
-void Swarm::performPhaseTasks() {
+void Swarm::performPhaseTasks(double now) {
     if (phase == Phases::Planning && !planningInitialized) {
         //initialize the external operations such as slam or task assignment
         try {
             if(horizonId < planningPhase->nHorizons) {
-                planningPhase->doPlanning(horizonId, prevTrl);
+                recordPlanningEvent(PlanningStarted, horizonId);
+                planningPhase->doPlanning(horizonId, prevTrl, getExpectedStart());
             }
             if (++horizonId > planningPhase->nHorizons) {
                 executionInitialized = true;
@@ -200,29 +648,184 @@ void Swarm::performPhaseTasks() {
         }
         catch (runtime_error &e) {
             ROS_WARN_STREAM(e.what());
-            planningPhase->planning_t->join();
+            recordPlanningEvent(PlanningFailed, horizonId);
             //set executionInitialized to true. So then it won't expect a value for the future.
             executionInitialized = true;
         }
         planningInitialized = true;
     } else if (phase == Phases::Execution && !executionInitialized) {
         //get the optimized trajectories from planningPhase and push them to the drones
-        vector<Trajectory> results = planningPhase->getPlanningResults();
+        vector<TrajectoryPtr> results = planningPhase->getPlanningResults();
+        if ((int) results.size() != n_drones) {
+            //nothing to push, the drones fly out the queued horizons and the mission ends there
+            ROS_ERROR_STREAM("Planning horizon " << horizonId - 1 << " failed. Ending the mission after the queued horizons");
+            recordPlanningEvent(PlanningFailed, horizonId - 1);
+            planningPhase->nHorizons = horizonId - 1;
+            executionInitialized = true;
+            return;
+        }
         ROS_DEBUG_STREAM("Optimization results retrieved");
+        recordPlanningEvent(PlanningCommitted, horizonId - 1);
         for (int i = 0; i < n_drones; i++) {
             dronesList[i]->pushTrajectory(results[i]);
         }
-        this->prevTrl = results;
+        publishPlan(horizonId - 1, results);
+        this->prevTrl = move(results);
+        //a resume should not have to plan the committed horizon again
+        saveCheckpoint(now);
 
         executionInitialized = true;
     }
 }
 
-void Swarm::setWaypoints(vector<Trajectory> wpts_, vector<double> tList_) {
-    if (phase == Phases::Planning) {
-        this->wpts = move(wpts_);
-        this->tList = move(tList_);
-    } else {
-        ROS_WARN_STREAM("Swarm is not in the planning phase. Waypoints rejected");
+void Swarm::setWaypoints(vector<Trajectory> droneWpts, vector<double> tList_) {
+    for (int i = 0; i < (int) droneWpts.size(); i++) {
+        if (droneWpts[i].pos.empty()) {
+            continue;
+        }
+        droneWpts[i].tList = tList_;
+        setWaypoints(i, move(droneWpts[i]));
+    }
+}
+
+void Swarm::setWaypoints(int droneId, Trajectory wpts_) {
+    if (predefined) {
+        ROS_WARN_STREAM("Swarm is flying predefined trajectories. Waypoints rejected");
+        return;
+    }
+    WaypointUpdate update;
+    update.droneId = droneId;
+    update.wpts = move(wpts_);
+    if (!planningPhase->pushWaypoints(move(update))) {
+        ROS_WARN_STREAM("Waypoint queue is full. Waypoints rejected for drone " << droneId);
+    }
+}
+
+void Swarm::initWaypointStreams() {
+    for (int i = 0; i < n_drones; i++) {
+        stringstream ss;
+        ss << "waypoints/" << i;
+        waypointSubs.push_back(nh.subscribe<nav_msgs::Path>(ss.str(), 10,
+                                                            boost::bind(&Swarm::waypointsCB, this, _1, i)));
+    }
+}
+
+void Swarm::waypointsCB(const nav_msgs::PathConstPtr &msg, int droneId) {
+    Trajectory wpts_;
+    double prevT = 0;
+    for (const geometry_msgs::PoseStamped &pose : msg->poses) {
+        double t = pose.header.stamp.toSec();
+        wpts_.pos.push_back(Eigen::Vector3d(pose.pose.position.x, pose.pose.position.y, pose.pose.position.z));
+        wpts_.tList.push_back(t - prevT);
+        prevT = t;
+    }
+    setWaypoints(droneId, move(wpts_));
+}
+
+bool Swarm::spliceWaypoints(vector<Trajectory> viaWpts, double leadTime) {
+    if (predefined || state != States::Autonomous) {
+        ROS_WARN_STREAM("Swarm is not executing planned trajectories. Splice rejected");
+        return false;
+    }
+    if (splicePending) {
+        ROS_WARN_STREAM("A splice is already being planned. Splice rejected");
+        return false;
+    }
+    int leadTicks = (int) ceil(leadTime * frequency);
+    vector<Trajectory> wpts_;
+    vector<TrajectoryState> startStates, endStates;
+    spliceDrones.clear();
+    spliceIdx.clear();
+    spliceTrajectoryIds.clear();
+    for (int i = 0; i < n_drones && i < (int) viaWpts.size(); i++) {
+        if (viaWpts[i].pos.empty()) {
+            continue;
+        }
+        if (viaWpts[i].pos.size() != viaWpts[i].tList.size()) {
+            ROS_WARN_STREAM("Splice rejected. Expected one time per via point for drone " << i);
+            return false;
+        }
+        int idx, trajectoryId;
+        TrajectoryState start;
+        if (!dronesList[i]->getSplicePoint(leadTicks, idx, start, trajectoryId)) {
+            ROS_WARN_STREAM("Splice rejected. Drone " << i << " finishes its horizon within the lead time");
+            return false;
+        }
+        double remaining = (dronesList[i]->getTrajectorySize() - 1 - idx) / frequency;
+        double viaTime = 0;
+        for (double t : viaWpts[i].tList) {
+            viaTime += t;
+        }
+        if (viaTime >= remaining) {
+            ROS_WARN_STREAM("Splice rejected. Via points of drone " << i << " need " << viaTime
+                                    << "s but the horizon ends in " << remaining << "s");
+            return false;
+        }
+        Trajectory w;
+        w.pos.push_back(start.pos);
+        w.pos.append(viaWpts[i].pos);
+        w.tList = viaWpts[i].tList;
+        TrajectoryState end = dronesList[i]->getEndState();
+        w.pos.push_back(end.pos);
+        w.tList.push_back(remaining - viaTime);
+
+        wpts_.push_back(w);
+        startStates.push_back(start);
+        endStates.push_back(end);
+        spliceDrones.push_back(i);
+        spliceIdx.push_back(idx);
+        spliceTrajectoryIds.push_back(trajectoryId);
+    }
+    if (spliceDrones.empty()) {
+        return false;
+    }
+    PlanningPhase *pp = planningPhase;
+    double frequency_ = frequency;
+    spliceFut = async(launch::async, [pp, frequency_, wpts_, startStates, endStates]() {
+        Solver solver(wpts_.size(), pp->maxVelocity, pp->maxAcceleration, frequency_);
+        solver.setPartitioning(pp->partitionCellSize, pp->minSeparation);
+        return solver.solve(wpts_, startStates, endStates);
+    });
+    splicePending = true;
+    recordPlanningEvent(SpliceStarted, horizonId - 1);
+    ROS_DEBUG_STREAM("Planning a splice for " << spliceDrones.size() << " drones " << leadTicks << " ticks ahead");
+    return true;
+}
+
+void Swarm::performSpliceTasks() {
+    if (!splicePending || spliceFut.wait_for(chrono::seconds(0)) != future_status::ready) {
+        return;
+    }
+    splicePending = false;
+    vector<TrajectoryPtr> splices = spliceFut.get();
+    recordPlanningEvent(SpliceAdopted, horizonId - 1);
+    for (size_t j = 0; j < spliceDrones.size() && j < splices.size(); j++) {
+        dronesList[spliceDrones[j]]->spliceTrajectory(*splices[j], spliceTrajectoryIds[j], spliceIdx[j]);
+    }
+}
+
+void Swarm::performCompiledTasks() {
+    if (compiledHorizons >= compiledMission->getHorizons()) {
+        return;
+    }
+    for (int i = 0; i < n_drones; i++) {
+        if (dronesList[i]->getTrajectoryId() + 1 >= compiledHorizons) {
+            pushCompiledHorizon();
+            return;
+        }
+    }
+}
+
+void Swarm::pushCompiledHorizon() {
+    vector<TrajectoryPtr> trajectories;
+    for (int i = 0; i < n_drones; i++) {
+        trajectories.push_back(CompiledMission::getTrajectoryView(compiledMission, i, compiledHorizons));
+        dronesList[i]->pushTrajectory(trajectories[i]);
+    }
+    if (visualizeTraj) {
+        vis->addToPaths(trajectories);
     }
+    publishPlan(compiledHorizons, trajectories);
+    ROS_DEBUG_STREAM("Pushed compiled horizon " << compiledHorizons);
+    compiledHorizons++;
 }
@@ -0,0 +1,47 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <memory>
+#include <thread>
+#include "Swarm.h"
+
+namespace swarmsim {
+
+/**
+ * The swarm as a nodelet, so the drone executors can be loaded into the same manager and
+ * receive their horizons without serialization. Takes the params of the swarmsim_example node
+ * as private params.
+ */
+class SwarmNodelet : public nodelet::Nodelet {
+public:
+    ~SwarmNodelet() {
+        if (starter.joinable()) {
+            starter.join();
+        }
+        if (swarm) {
+            swarm->stop();
+        }
+    }
+
+private:
+    std::thread starter;
+    std::unique_ptr<Swarm> swarm;
+
+    void onInit() override {
+        //the swarm waits for the simulation while it is built, which must not block the manager
+        starter = std::thread([this]() {
+            double frequency;
+            getPrivateNodeHandle().param("frequency", frequency, 100.0);
+            swarm.reset(Swarm::create(getPrivateNodeHandle(), frequency));
+            if (!swarm) {
+                NODELET_ERROR_STREAM("Failed to create the swarm");
+                return;
+            }
+            //the timers run on the single threaded queue of the manager, one at a time as in the node
+            swarm->start(frequency);
+        });
+    }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(swarmsim::SwarmNodelet, nodelet::Nodelet)
@@ -0,0 +1,46 @@
+#include "TrajectoryArena.h"
+#include "MemoryAccounting.h"
+#include <cstdlib>
+#include <new>
+
+TrajectoryArena::TrajectoryArena(size_t blockSize) : cur(nullptr), left(0), blockSize(blockSize), reserved(0) {}
+
+TrajectoryArena::~TrajectoryArena() {
+    for (char *block : blocks) {
+        free(block);
+    }
+    MemoryAccounting::released(TrajectoryMemory, reserved);
+}
+
+double *TrajectoryArena::allocate(size_t n) {
+    size_t size = (n * sizeof(double) + 63) & ~(size_t) 63;
+    lock_guard<mutex> lock(arenaMutex);
+    if (size > blockSize / 4) {
+        //a large request would waste most of a shared block, the current block stays in use
+        return (double *) allocateBlock(size);
+    }
+    if (size > left) {
+        cur = allocateBlock(blockSize);
+        left = blockSize;
+    }
+    double *p = (double *) cur;
+    cur += size;
+    left -= size;
+    return p;
+}
+
+size_t TrajectoryArena::getReserved() {
+    lock_guard<mutex> lock(arenaMutex);
+    return reserved;
+}
+
+char *TrajectoryArena::allocateBlock(size_t size) {
+    void *block = nullptr;
+    if (posix_memalign(&block, 64, size) != 0) {
+        throw bad_alloc();
+    }
+    blocks.push_back((char *) block);
+    reserved += size;
+    MemoryAccounting::allocated(TrajectoryMemory, size);
+    return (char *) block;
+}
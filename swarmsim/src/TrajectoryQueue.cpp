@@ -0,0 +1,114 @@
+#include "TrajectoryQueue.h"
+
+TrajectoryQueue::TrajectoryQueue() : trajectoryId(0), execPointer(0), start(-1) {}
+
+void TrajectoryQueue::push(TrajectoryPtr trajectory) {
+    trajectories.push_back(move(trajectory));
+    //setting the initial trajectory
+    if (trajectories.size() == 1) {
+        setCurrent(trajectories.front());
+    }
+}
+
+bool TrajectoryQueue::sample(double now, double sampleRate, TrajectoryState &reference) {
+    if (start < 0) {
+        //first setpoint, or the first one after a resume in the middle of a trajectory
+        start = now - execPointer / sampleRate;
+    }
+    int last = trajectory->pos.size() - 1;
+    //move on to the queued horizons whose start has passed
+    while ((now - start) * sampleRate >= last && trajectories.size() > 1) {
+        //retire the executed horizon, its arena is freed once the planner and the visualization drop it too
+        trajectories.pop_front();
+        trajectoryId++;
+        start += last / sampleRate;
+        setCurrent(trajectories.front());
+        last = trajectory->pos.size() - 1;
+    }
+    double t = now - start;
+    if (t * sampleRate < last) {
+        //the round-off of a resumed start must not put the drone a sample behind its checkpoint
+        execPointer = (int) (t * sampleRate + 1e-6);
+        reference = trajectory->interpolate(t, sampleRate);
+        return true;
+    }
+    execPointer = last;
+    reference = trajectory->getState(last);
+    return false;
+}
+
+bool TrajectoryQueue::getSplicePoint(int ticksAhead, int &spliceIdx, TrajectoryState &state) const {
+    spliceIdx = execPointer + ticksAhead;
+    if (spliceIdx >= (int) trajectory->pos.size() - 1) {
+        return false;
+    }
+    state = trajectory->getState(spliceIdx);
+    return true;
+}
+
+bool TrajectoryQueue::splice(const Trajectory &splice, int trajectoryId_, int spliceIdx) {
+    if (trajectoryId_ != trajectoryId || execPointer > spliceIdx || splice.pos.empty()) {
+        return false;
+    }
+    //keep the executed part so execPointer and the horizon progress stay valid
+    auto spliced = make_shared<Trajectory>();
+    spliced->allocate(spliceIdx + splice.pos.size());
+    for (int i = 0; i < (int) spliced->pos.size(); i++) {
+        TrajectoryState s = i < spliceIdx ? trajectory->getState(i) : splice.getState(i - spliceIdx);
+        spliced->pos[i] = s.pos;
+        spliced->vel[i] = s.vel;
+        spliced->acc[i] = s.acc;
+    }
+    spliced->tList = trajectory->tList;
+
+    trajectories.front() = spliced;
+    trajectory = spliced;
+    return true;
+}
+
+const TrajectoryPtr &TrajectoryQueue::getCurrent() const {
+    return trajectory;
+}
+
+const TrajectoryPtr &TrajectoryQueue::getLast() const {
+    return trajectories.empty() ? trajectory : trajectories.back();
+}
+
+const TrajectoryPtr &TrajectoryQueue::get(size_t i) const {
+    return trajectories[i];
+}
+
+size_t TrajectoryQueue::size() const {
+    return trajectories.size();
+}
+
+int TrajectoryQueue::getTrajectoryId() const {
+    return trajectoryId;
+}
+
+int TrajectoryQueue::getExecPointer() const {
+    return execPointer;
+}
+
+double TrajectoryQueue::getStart() const {
+    return start;
+}
+
+void TrajectoryQueue::getCheckpoint(DroneCheckpoint &checkpoint) const {
+    checkpoint.trajectoryId = trajectoryId;
+    checkpoint.execPointer = execPointer;
+    checkpoint.trajectories.assign(trajectories.begin(), trajectories.end());
+}
+
+void TrajectoryQueue::restore(const DroneCheckpoint &checkpoint) {
+    trajectories.assign(checkpoint.trajectories.begin(), checkpoint.trajectories.end());
+    trajectoryId = checkpoint.trajectoryId;
+    trajectory = trajectories.front();
+    execPointer = checkpoint.execPointer;
+    start = -1;
+}
+
+void TrajectoryQueue::setCurrent(TrajectoryPtr trajectory) {
+    execPointer = 0;
+    this->trajectory = move(trajectory);
+}
@@ -0,0 +1,212 @@
+#include "TrajectoryRegistry.h"
+#include "MemoryAccounting.h"
+#include "SeriesLayout.h"
+#include <ros/console.h>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using serieslayout::align64;
+using serieslayout::copyComponent;
+
+namespace {
+    const char MAGIC[8] = {'S', 'W', 'A', 'R', 'M', 'R', 'E', 'G'};
+}
+
+TrajectoryRegistry::TrajectoryRegistry(const string &name, int nDrones, int capacity, double frequency)
+        : name(name), owner(true), base(nullptr), length(0), header(nullptr) {
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the registry needs lock free 64 bit atomics");
+    if (nDrones < 1 || capacity < 1) {
+        throw runtime_error("A trajectory registry needs at least one drone and one sample");
+    }
+    uint64_t slotSize = align64(sizeof(RegistrySlot)) + NumSeries * align64(capacity * sizeof(double));
+    length = align64(sizeof(TrajectoryRegistryHeader)) + nDrones * slotSize;
+
+    //a registry left behind by a crashed writer is replaced, readers still mapping it keep the old one
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw runtime_error("Failed to create the trajectory registry " + name + ": " + strerror(errno));
+    }
+    if (ftruncate(fd, length) != 0) {
+        int err = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        throw runtime_error("Failed to size the trajectory registry " + name + ": " + strerror(err));
+    }
+    void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw runtime_error("Failed to map the trajectory registry " + name + ": " + strerror(errno));
+    }
+    base = (char *) addr;
+    //the new object is zero filled, so every slot starts unwritten
+    header = new(base) TrajectoryRegistryHeader;
+    header->version = VERSION;
+    header->nDrones = nDrones;
+    header->capacity = capacity;
+    header->reserved = 0;
+    header->frequency = frequency;
+    header->slotSize = slotSize;
+    header->generation.store(0, memory_order_relaxed);
+    for (int k = 0; k < nDrones; k++) {
+        RegistrySlot *slot = new(base + align64(sizeof(TrajectoryRegistryHeader)) + k * slotSize) RegistrySlot;
+        slot->seq.store(0, memory_order_relaxed);
+        slot->horizonId = -1;
+        slot->nSamples = 0;
+    }
+    //readers check the magic last, it marks the layout as complete
+    atomic_thread_fence(memory_order_release);
+    memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    MemoryAccounting::allocated(RegistryMemory, length);
+    ROS_DEBUG_STREAM("Created the trajectory registry " << name << ": " << nDrones << " drones, " << capacity
+                                                        << " samples, " << length / 1e6 << " MB");
+}
+
+TrajectoryRegistry::TrajectoryRegistry(const string &name)
+        : name(name), owner(false), base(nullptr), length(0), header(nullptr) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw runtime_error("Failed to open the trajectory registry " + name + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(TrajectoryRegistryHeader)) {
+        close(fd);
+        throw runtime_error(name + " is not a trajectory registry");
+    }
+    length = st.st_size;
+    void *addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw runtime_error("Failed to map the trajectory registry " + name + ": " + strerror(errno));
+    }
+    base = (char *) addr;
+    header = (TrajectoryRegistryHeader *) base;
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION
+        || align64(sizeof(TrajectoryRegistryHeader)) + header->nDrones * header->slotSize > length) {
+        munmap(base, length);
+        throw runtime_error(name + " is not a trajectory registry of version " + to_string(VERSION));
+    }
+    atomic_thread_fence(memory_order_acquire);
+}
+
+TrajectoryRegistry::~TrajectoryRegistry() {
+    munmap(base, length);
+    if (owner) {
+        shm_unlink(name.c_str());
+        MemoryAccounting::released(RegistryMemory, length);
+    }
+}
+
+int TrajectoryRegistry::getDrones() const {
+    return header->nDrones;
+}
+
+int TrajectoryRegistry::getCapacity() const {
+    return header->capacity;
+}
+
+double TrajectoryRegistry::getFrequency() const {
+    return header->frequency;
+}
+
+uint64_t TrajectoryRegistry::getGeneration() const {
+    return header->generation.load(memory_order_acquire);
+}
+
+void TrajectoryRegistry::publish(int horizonId, const vector<TrajectoryPtr> &plan) {
+    int nDrones = min((int) plan.size(), (int) header->nDrones);
+    for (int k = 0; k < nDrones; k++) {
+        const Trajectory &tr = *plan[k];
+        RegistrySlot *slot = getSlot(k);
+        uint64_t seq = slot->seq.load(memory_order_relaxed);
+        slot->seq.store(seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        int n = min((int) tr.pos.size(), (int) header->capacity);
+        slot->horizonId = horizonId;
+        slot->nSamples = n;
+        for (int dim = 0; dim < 3; dim++) {
+            copyComponent(tr.pos, dim, n, getSlotSeries(k, PosX + dim));
+            copyComponent(tr.vel, dim, n, getSlotSeries(k, VelX + dim));
+            copyComponent(tr.acc, dim, n, getSlotSeries(k, AccX + dim));
+        }
+        slot->seq.store(seq + 2, memory_order_release);
+        if (n < (int) tr.pos.size()) {
+            ROS_WARN_STREAM_ONCE("Trajectories longer than the registry capacity of " << header->capacity
+                                                                                      << " samples are truncated");
+        }
+    }
+    header->generation.fetch_add(1, memory_order_release);
+}
+
+uint64_t TrajectoryRegistry::beginRead(int droneId) const {
+    const RegistrySlot *slot = getSlot(droneId);
+    uint64_t seq;
+    while ((seq = slot->seq.load(memory_order_acquire)) & 1) {
+        this_thread::yield();
+    }
+    return seq;
+}
+
+bool TrajectoryRegistry::endRead(int droneId, uint64_t seq) const {
+    atomic_thread_fence(memory_order_acquire);
+    return getSlot(droneId)->seq.load(memory_order_relaxed) == seq;
+}
+
+int TrajectoryRegistry::getHorizonId(int droneId) const {
+    return getSlot(droneId)->horizonId;
+}
+
+int TrajectoryRegistry::getSamples(int droneId) const {
+    //bounded even when read in the middle of a write
+    return min(getSlot(droneId)->nSamples, header->capacity);
+}
+
+const double *TrajectoryRegistry::getSeries(int droneId, int series) const {
+    return getSlotSeries(droneId, series);
+}
+
+bool TrajectoryRegistry::read(int droneId, int &horizonId, Trajectory &tr) const {
+    while (true) {
+        uint64_t seq = beginRead(droneId);
+        if (seq == 0) {
+            return false;
+        }
+        int n = getSamples(droneId);
+        horizonId = getHorizonId(droneId);
+        const double *series[NumSeries];
+        for (int s = 0; s < NumSeries; s++) {
+            series[s] = getSeries(droneId, s);
+        }
+        tr.allocate(n);
+        for (int dim = 0; dim < 3; dim++) {
+            memcpy(tr.pos.data(dim), series[PosX + dim], n * sizeof(double));
+            memcpy(tr.vel.data(dim), series[VelX + dim], n * sizeof(double));
+            memcpy(tr.acc.data(dim), series[AccX + dim], n * sizeof(double));
+        }
+        if (endRead(droneId, seq)) {
+            return true;
+        }
+    }
+}
+
+RegistrySlot *TrajectoryRegistry::getSlot(int droneId) const {
+    if (droneId < 0 || droneId >= (int) header->nDrones) {
+        throw range_error("No registry slot for drone " + to_string(droneId));
+    }
+    return (RegistrySlot *) (base + align64(sizeof(TrajectoryRegistryHeader)) + droneId * header->slotSize);
+}
+
+double *TrajectoryRegistry::getSlotSeries(int droneId, int series) const {
+    uint64_t stride = align64(header->capacity * sizeof(double));
+    return (double *) ((char *) getSlot(droneId) + align64(sizeof(RegistrySlot)) + series * stride);
+}
@@ -1,13 +1,22 @@
 #include "Visualize.h"
 #include <ros/console.h>
-#include <yaml.h>
-#include <regex>
+#include "utils.h"
+#include "MemoryAccounting.h"
 
 Visualize::Visualize(ros::NodeHandle nh, string worldframe, int ndrones, string obstacleConfigFilePath)
-            : nh(nh), worldframe(worldframe), ndrones(ndrones), 
-            obstacleConfigFilePath(obstacleConfigFilePath) {
-    obstacles = this->readObstacleConfig();
+            : Visualize(nh, worldframe, ndrones, readObstacleConfig(obstacleConfigFilePath)) {
+    this->obstacleConfigFilePath = obstacleConfigFilePath;
+}
+
+Visualize::Visualize(ros::NodeHandle nh, string worldframe, int ndrones, vector<Obstacle> obstacles)
+            : nh(nh), worldframe(worldframe), ndrones(ndrones), accountedBytes(0), ringBytes(0),
+              obstacles(move(obstacles)) {
+    int maxPathPoints;
+    nh.param("maxPathPoints", maxPathPoints, 10000);
+    this->maxPoints = maxPathPoints;
     this->initMarkers();
+    trajPoints.resize(marker_traj.size());
+    agentPathPoints.resize(maker_agentPaths.size());
     this->markerPub_traj = nh.advertise<visualization_msgs::Marker>("visualization_marker/traj", 10);
     this->markerPub_obs = nh.advertise<visualization_msgs::Marker>("visualization_marker/obs", 10);
     this->markerPub_samples = nh.advertise<visualization_msgs::Marker>("visualization_marker/samples", 10);
@@ -15,6 +24,10 @@ Visualize::Visualize(ros::NodeHandle nh, string worldframe, int ndrones, string
     this->markerPub_topo = nh.advertise<visualization_msgs::Marker>("visualization_marker/topo", 10); 
 }
 
+Visualize::~Visualize() {
+    MemoryAccounting::released(VisualizationMemory, accountedBytes + ringBytes);
+}
+
 void Visualize::initMarkers() {
     //marker for the robot trajectories
     for(int i=0;i<this->ndrones;i++)  {
@@ -123,36 +136,34 @@ void Visualize::addAgentPaths(std::vector<std::vector<geometry_msgs::Point>> sch
     std::cout<<"schedule: "<<schedule.size()<<std::endl;
 
     for(int i=0;i<schedule.size(); i++) {
-        for(int p=0;p<schedule[i].size(); p++) {
-            maker_agentPaths[i].points.push_back(schedule[i][p]);
-        }
+        appendPoints(agentPathPoints[i], schedule[i]);
     }
+    updateAccounting();
 }
 
 void Visualize::addToTopo(std::vector<geometry_msgs::Point> pts) {
-    for(int i=0; i<pts.size();i++) {
-        topoMarker.points.push_back(pts[i]);
-    }
+    appendPoints(topoPoints, pts);
+    updateAccounting();
 }
 
-void Visualize::addToPaths(vector<Trajectory> trajs) {
+void Visualize::addToPaths(const vector<TrajectoryPtr> &trajs) {
     for(int i=0; i < trajs.size(); i++) {
-        Trajectory traj = trajs[i];
+        const Trajectory &traj = *trajs[i];
         ROS_DEBUG_STREAM("position list size: "<<traj.pos.size() << " " << traj.pos[0][0] << " " << traj.pos[0][1] << " " << traj.pos[0][2]);
+        std::vector<geometry_msgs::Point> pts(traj.pos.size());
         for (int p = 0; p < traj.pos.size(); p++) {
-            geometry_msgs::Point pt;
-            pt.x = traj.pos[p][0];
-            pt.y = traj.pos[p][1];
-            pt.z = traj.pos[p][2];
-            this->marker_traj[i].points.push_back(pt);
+            pts[p].x = traj.pos[p][0];
+            pts[p].y = traj.pos[p][1];
+            pts[p].z = traj.pos[p][2];
         }
+        appendPoints(trajPoints[i], pts);
     }
+    updateAccounting();
 }
 
 void Visualize::addStartGoal(std::vector<geometry_msgs::Point> pts) {
-    for(int i=0; i<pts.size();i++) {
-        startMarker.points.push_back(pts[i]);
-    }
+    appendPoints(startPoints, pts);
+    updateAccounting();
 }
 
 
@@ -164,113 +175,64 @@ void Visualize::draw() {
     // for(int i = 0; i<obstacles.size(); i++) {
     //     markerPub_obs.publish(marker_obs[i]);
     // }
+    copyPoints(gridPoints, gridMarker.points);
     markerPub_samples.publish(gridMarker);
+    copyPoints(startPoints, startMarker.points);
     markerPub_samples.publish(startMarker);
     for(int i=0;i<this->maker_agentPaths.size();i++) {
+        copyPoints(agentPathPoints[i], maker_agentPaths[i].points);
         markerPub_paths.publish(maker_agentPaths[i]);
     }
+    copyPoints(topoPoints, topoMarker.points);
     markerPub_topo.publish(topoMarker);
+    //the copies grow the points of the markers up to the size of their rings
+    updateAccounting();
 }
 
 void Visualize::addToGrid(std::vector<geometry_msgs::Point> ptsArray) {
-    for(int i=0;i<ptsArray.size();i++) {
-        geometry_msgs::Point pt = ptsArray[i];
-        this->gridMarker.points.push_back(pt);
-    }
+    appendPoints(gridPoints, ptsArray);
+    updateAccounting();
 }
 
-std::vector<Obstacle> Visualize::readObstacleConfig() {
-    ROS_DEBUG_STREAM("YAML file path: " << obstacleConfigFilePath);
-    char cstr[obstacleConfigFilePath.size() + 1];
-    copy(obstacleConfigFilePath.begin(), obstacleConfigFilePath.end(), cstr);
-    cstr[obstacleConfigFilePath.size()] = '\0';
-    const std::regex obs_regex("obstacle(\\d)");
-    std::smatch pieces_match;
-    std::vector<Obstacle> obsList;
-
-    try {
-        FILE *fh = fopen(cstr, "r");
-        yaml_parser_t parser;
-        yaml_token_t token;
+void Visualize::appendPoints(PointRing &ring, const std::vector<geometry_msgs::Point> &pts) {
+    if (ring.capacity() < maxPoints) {
+        size_t bytes = (maxPoints - ring.capacity()) * sizeof(geometry_msgs::Point);
+        ring.set_capacity(maxPoints);
+        MemoryAccounting::allocated(VisualizationMemory, bytes);
+        ringBytes += bytes;
+    }
+    //a full ring overwrites its oldest point, so appending costs the same however long the mission
+    size_t first = pts.size() > maxPoints ? pts.size() - maxPoints : 0;
+    for (size_t p = first; p < pts.size(); p++) {
+        ring.push_back(pts[p]);
+    }
+}
 
-        if (!yaml_parser_initialize(&parser)) {
-            ROS_ERROR_STREAM("Failed to initialize parser!");
-        }
-        if (fh == NULL) {
-            ROS_ERROR_STREAM("Failed to open file!\n" );
-        }
-        yaml_parser_set_input_file(&parser, fh);
-        bool blockMapping, keyToken, valueToken;
-        string currentKey;
-        Obstacle ob;
-        int valueLength;
-        do {
-            yaml_parser_scan(&parser, &token);
-            switch (token.type)
-            {
-            case YAML_STREAM_START_TOKEN:
-                puts("YAMLObstacle: STREAM START");
-                break;
-            case YAML_STREAM_END_TOKEN:
-                puts("YAMLObstacle: STREAM END");
-                break;
-            case YAML_KEY_TOKEN:
-                keyToken = true;
-                valueToken = false;
-                valueLength = 0;
-                break;
-            case YAML_VALUE_TOKEN:
-                keyToken = false;
-                valueToken = true;
-                break;
-            case YAML_BLOCK_SEQUENCE_START_TOKEN:
-                break;
-            case YAML_BLOCK_ENTRY_TOKEN:
-                break;
-            case YAML_BLOCK_END_TOKEN:
-                blockMapping = false;
-                break;
-            case YAML_BLOCK_MAPPING_START_TOKEN:
-                blockMapping = true;
-                break;
-            case YAML_SCALAR_TOKEN:
-                char *c = (char *) token.data.scalar.value;
-                string s = std::string(c);
+void Visualize::copyPoints(const PointRing &ring, std::vector<geometry_msgs::Point> &points) {
+    points.assign(ring.begin(), ring.end());
+}
 
-                if (keyToken) {
-                    currentKey = s;
-                }
-                if (valueToken) {
-                    if(currentKey.compare("center") == 0) {
-                        ob.center[valueLength] = std::stod(s);
-                    }
-                    else if(currentKey.compare("height") == 0) {
-                        ob.height = std::stod(s);
-                    }
-                    else if(currentKey.compare("width") == 0) {
-                        ob.width = std::stod(s);
-                    }
-                    else if(currentKey.compare("length") == 0) {
-                        ob.length = std::stod(s);
-                        obsList.push_back(ob);
-                        printf("YAMLObstacle: Obstacle pushed \n");
-                    }
-                valueLength++;
-                }
-                break;
+void Visualize::updateAccounting() {
+    size_t bytes = 0;
+    for (const visualization_msgs::Marker &m : marker_traj) {
+        bytes += m.points.capacity() * sizeof(geometry_msgs::Point);
+    }
+    for (const visualization_msgs::Marker &m : maker_agentPaths) {
+        bytes += m.points.capacity() * sizeof(geometry_msgs::Point);
+    }
+    bytes += (gridMarker.points.capacity() + startMarker.points.capacity() + topoMarker.points.capacity())
+             * sizeof(geometry_msgs::Point);
+    MemoryAccounting::allocated(VisualizationMemory, bytes);
+    MemoryAccounting::released(VisualizationMemory, accountedBytes);
+    accountedBytes = bytes;
+}
 
-                
-            }
-            if(token.type != YAML_STREAM_END_TOKEN)
-            yaml_token_delete(&token);
-        }
-        while (token.type != YAML_STREAM_END_TOKEN);
-        yaml_token_delete(&token);
+std::vector<Obstacle> Visualize::readObstacleConfig(const string &obstacleConfigFilePath) {
+    try {
+        return simutils::readObstacleConfig(obstacleConfigFilePath);
     }
-    
-    catch(range_error &e) {
-        ROS_ERROR_STREAM(e.what());
+    catch (runtime_error &e) {
+        ROS_ERROR_STREAM("Failed to read the obstacles. " << e.what());
     }
-    ROS_DEBUG_STREAM("YAMLObstacle: Length: "<< obsList.size());
-    return obsList;
-}
\ No newline at end of file
+    return vector<Obstacle>();
+}
@@ -14,31 +14,31 @@ void YamlDescriptor::setSubGoals(int nSubgoals) {
     this->nSubgoals = nSubgoals;
 }
 
-int YamlDescriptor::getSubGoals() {
+int YamlDescriptor::getSubGoals() const {
     return this->nSubgoals;
 }
 
 void YamlDescriptor::setTimesArray(vector<HorizonTimes> timesArray) {
-    this->timesArray = timesArray;
+    this->timesArray = move(timesArray);
 }
 
-vector<HorizonTimes> YamlDescriptor::getTimesArray() {
+const vector<HorizonTimes> &YamlDescriptor::getTimesArray() const {
     return timesArray;
 }
 
 void YamlDescriptor::setDronesTrajectories(vector<DroneTrajectory> dronesTr) {
-    this->droneTrajectories = dronesTr;
+    this->droneTrajectories = move(dronesTr);
 }
 
-vector<DroneTrajectory> YamlDescriptor::getdroneTrajectories() {
+const vector<DroneTrajectory> &YamlDescriptor::getdroneTrajectories() const {
     return droneTrajectories;
 }
 
-int YamlDescriptor::getHorizons() {
+int YamlDescriptor::getHorizons() const {
     return this->nHorizons;
 }
 
-int YamlDescriptor::getDrones() {
+int YamlDescriptor::getDrones() const {
     return nDrones;
 }
 
@@ -50,10 +50,10 @@ void YamlDescriptor::setMovingThreshold(double val) {
     this->movingThreshold = val;
 }
 
-double YamlDescriptor::getHoveringThreshold() {
+double YamlDescriptor::getHoveringThreshold() const {
     return hoveringThreshold;
 }
 
-double YamlDescriptor::getMovingThreshold() {
+double YamlDescriptor::getMovingThreshold() const {
     return movingThreshold;
 }
\ No newline at end of file
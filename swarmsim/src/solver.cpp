@@ -5,79 +5,150 @@
 #include <mav_trajectory_generation_ros/ros_conversions.h>
 #include <mav_trajectory_generation_ros/ros_visualization.h>
 #include <mav_trajectory_generation/trajectory_sampling.h>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 namespace mtg = mav_trajectory_generation;
 
+static const int derivative_to_optimize = mtg::derivative_order::SNAP;
+
 Solver::Solver(int nDrones, double maxVel, double maxAcc,
                double frequency)
         : K(nDrones), maxVel(maxVel), maxAcc(maxAcc), nChecks(nChecks) {
     dt = (double) 1 / frequency;
 }
 
-vector<Trajectory> Solver::solve(vector<Trajectory> droneWpts, bool initial, bool last, std::vector<Trajectory> prevPlan) {
-    vector<Trajectory> trajList;
-    for (int k = 0; k < K; k++) {
-        Trajectory t_k = droneWpts[k];
-        vector<double> tList = droneWpts[k].tList;
-        Eigen::Vector3d zeroVec;
-        zeroVec << 0,0,0;
-        mav_trajectory_generation::Vertex::Vector vertices;
-        const int derivative_to_optimize = mav_trajectory_generation::derivative_order::SNAP;
-        for (int i = 0; i < t_k.pos.size(); i++) {
-            Eigen::Vector3d pos = t_k.pos[i];
-            mav_trajectory_generation::Vertex v(3);
-            if (i == 0 || i == t_k.pos.size() - 1) {
-                if(i == 0 && initial) {
-                    v.makeStartOrEnd(pos, derivative_to_optimize);
-                    v.addConstraint(mtg::derivative_order::VELOCITY, zeroVec);
-                }
-                else if(i==0 && !initial) {
-                    Trajectory prevTr = prevPlan[k];
-                    Vector3d initPos = prevTr.pos[prevTr.pos.size() - 1];
-                    Vector3d initVel = prevTr.vel[prevTr.vel.size() - 1];
-                    Vector3d initAcc = prevTr.acc[prevTr.acc.size() - 1];
-                    v.addConstraint(mtg::derivative_order::POSITION, initPos);
-                    // v.addConstraint(mtg::derivative_order::VELOCITY, initVel);
-                    // v.addConstraint(mtg::derivative_order::JERK, initAcc);
-                }
-                else if(i== t_k.pos.size() - 1 && last) {
-                    v.makeStartOrEnd(pos, derivative_to_optimize);
-                    v.addConstraint(mtg::derivative_order::VELOCITY, zeroVec);
-                    v.addConstraint(mtg::derivative_order::ACCELERATION, zeroVec);
-                }
-                else if(i== t_k.pos.size() - 1 && !last) {
-                    v.addConstraint(mtg::derivative_order::POSITION, pos);
-                }
-            }
-            else {
-                v.addConstraint(mtg::derivative_order::POSITION, pos);
-            }
+void Solver::setPartitioning(double cellSize, double minSeparation) {
+    this->cellSize = cellSize;
+    this->minSeparation = minSeparation;
+}
+
+vector<TrajectoryPtr> Solver::solve(const vector<Trajectory> &droneWpts, bool initial, bool last,
+                                    const std::vector<TrajectoryPtr> &prevPlan) {
+    Eigen::Vector3d zeroVec;
+    zeroVec << 0,0,0;
+    auto solveOne = [&](int k) {
+        const Trajectory &t_k = droneWpts[k];
+        mav_trajectory_generation::Vertex start(3), end(3);
+        if(initial) {
+            start.makeStartOrEnd(t_k.pos[0], derivative_to_optimize);
+            start.addConstraint(mtg::derivative_order::VELOCITY, zeroVec);
+        }
+        else {
+            const Trajectory &prevTr = *prevPlan[k];
+            Vector3d initPos = prevTr.pos[prevTr.pos.size() - 1];
+            Vector3d initVel = prevTr.vel[prevTr.vel.size() - 1];
+            Vector3d initAcc = prevTr.acc[prevTr.acc.size() - 1];
+            start.addConstraint(mtg::derivative_order::POSITION, initPos);
+            // start.addConstraint(mtg::derivative_order::VELOCITY, initVel);
+            // start.addConstraint(mtg::derivative_order::ACCELERATION, initAcc);
+        }
+        if(last) {
+            end.makeStartOrEnd(t_k.pos[t_k.pos.size() - 1], derivative_to_optimize);
+            end.addConstraint(mtg::derivative_order::VELOCITY, zeroVec);
+            end.addConstraint(mtg::derivative_order::ACCELERATION, zeroVec);
+        }
+        else {
+            end.addConstraint(mtg::derivative_order::POSITION, t_k.pos[t_k.pos.size() - 1]);
+        }
+        return solveDrone(t_k, start, end);
+    };
+    return solveClusters(droneWpts, solveOne);
+}
+
+vector<TrajectoryPtr> Solver::solve(const vector<Trajectory> &droneWpts, const vector<TrajectoryState> &startStates,
+                                    const vector<TrajectoryState> &endStates) {
+    auto solveOne = [&](int k) {
+        mav_trajectory_generation::Vertex start(3), end(3);
+        start.addConstraint(mtg::derivative_order::POSITION, startStates[k].pos);
+        start.addConstraint(mtg::derivative_order::VELOCITY, startStates[k].vel);
+        start.addConstraint(mtg::derivative_order::ACCELERATION, startStates[k].acc);
+        end.addConstraint(mtg::derivative_order::POSITION, endStates[k].pos);
+        end.addConstraint(mtg::derivative_order::VELOCITY, endStates[k].vel);
+        end.addConstraint(mtg::derivative_order::ACCELERATION, endStates[k].acc);
+        return solveDrone(droneWpts[k], start, end);
+    };
+    return solveClusters(droneWpts, solveOne);
+}
 
-            vertices.push_back(v);
+vector<TrajectoryPtr> Solver::solveClusters(const vector<Trajectory> &droneWpts, const function<Trajectory(int)> &solveOne) {
+    vector<TrajectoryPtr> trajList(K);
+    //every trajectory of the horizon is sampled into the same arena
+    arena = make_shared<TrajectoryArena>();
+    Partitioner partitioner(cellSize, minSeparation);
+    Partition partition = partitioner.partition(droneWpts);
+    ROS_DEBUG_STREAM("Planning " << K << " drones in " << partition.clusters.size() << " clusters, "
+                                 << partition.boundaryPairs.size() << " boundary pairs");
+    conflicts.clear();
+    mutex conflictsMutex;
+    atomic<int> nextCluster(0);
+    auto planClusters = [&]() {
+        for (int c = nextCluster++; c < (int) partition.clusters.size(); c = nextCluster++) {
+            const vector<int> &cluster = partition.clusters[c];
+            for (int k : cluster) {
+                trajList[k] = make_shared<const Trajectory>(solveOne(k));
+            }
+            vector<pair<int, int> > clusterConflicts = partitioner.findConflicts(cluster, partition, trajList);
+            lock_guard<mutex> lock(conflictsMutex);
+            conflicts.insert(conflicts.end(), clusterConflicts.begin(), clusterConflicts.end());
         }
+    };
+    int nWorkers = min<int>(max<int>(thread::hardware_concurrency(), 1), partition.clusters.size());
+    vector<thread> workers;
+    for (int w = 1; w < nWorkers; w++) {
+        workers.push_back(thread(planClusters));
+    }
+    planClusters();
+    for (thread &worker : workers) {
+        worker.join();
+    }
 
-        mtg::NonlinearOptimizationParameters parameters;
-        mav_trajectory_generation::PolynomialOptimizationNonLinear<10> opt(3, parameters);
-        opt.setupFromVertices(vertices, tList, derivative_to_optimize);
-        opt.addMaximumMagnitudeConstraint(mav_trajectory_generation::derivative_order::VELOCITY, maxVel);
-        opt.addMaximumMagnitudeConstraint(mav_trajectory_generation::derivative_order::ACCELERATION, maxAcc);
-        opt.optimize();
-        mav_trajectory_generation::Trajectory trajectory;
-        opt.getTrajectory(&trajectory);
-        trajList.push_back(calculateTrajectoryWpts(trajectory));
+    //reconcile the drones whose regions cross cluster boundaries
+    vector<pair<int, int> > boundaryConflicts = partitioner.findConflicts(partition.boundaryPairs, trajList);
+    conflicts.insert(conflicts.end(), boundaryConflicts.begin(), boundaryConflicts.end());
+    for (const pair<int, int> &c : conflicts) {
+        ROS_WARN_STREAM("Drones " << c.first << " and " << c.second << " come closer than " << minSeparation << "m");
     }
     return trajList;
 }
 
+vector<pair<int, int> > Solver::getConflicts() {
+    return conflicts;
+}
+
+Trajectory Solver::solveDrone(const Trajectory &t_k, const mav_trajectory_generation::Vertex &start,
+                              const mav_trajectory_generation::Vertex &end) {
+    vector<double> tList = t_k.tList;
+    mav_trajectory_generation::Vertex::Vector vertices;
+    vertices.push_back(start);
+    for (int i = 1; i + 1 < (int) t_k.pos.size(); i++) {
+        mav_trajectory_generation::Vertex v(3);
+        v.addConstraint(mtg::derivative_order::POSITION, t_k.pos[i]);
+        vertices.push_back(v);
+    }
+    vertices.push_back(end);
+
+    mtg::NonlinearOptimizationParameters parameters;
+    mav_trajectory_generation::PolynomialOptimizationNonLinear<10> opt(3, parameters);
+    opt.setupFromVertices(vertices, tList, derivative_to_optimize);
+    opt.addMaximumMagnitudeConstraint(mav_trajectory_generation::derivative_order::VELOCITY, maxVel);
+    opt.addMaximumMagnitudeConstraint(mav_trajectory_generation::derivative_order::ACCELERATION, maxAcc);
+    opt.optimize();
+    mav_trajectory_generation::Trajectory trajectory;
+    opt.getTrajectory(&trajectory);
+    return calculateTrajectoryWpts(trajectory);
+}
+
 Trajectory Solver::calculateTrajectoryWpts(mtg::Trajectory& traj) {
     mav_msgs::EigenTrajectoryPoint::Vector flat_states;
     mav_trajectory_generation::sampleWholeTrajectory(traj, dt, &flat_states);
     Trajectory tr;
-    for (auto & flat_state : flat_states) {
-        tr.pos.push_back(flat_state.position_W);
-        tr.vel.push_back(flat_state.velocity_W);
-        tr.acc.push_back(flat_state.jerk_W);
-
+    tr.allocate(flat_states.size(), arena);
+    for (size_t i = 0; i < flat_states.size(); i++) {
+        tr.pos[i] = flat_states[i].position_W;
+        tr.vel[i] = flat_states[i].velocity_W;
+        tr.acc[i] = flat_states[i].acceleration_W;
     }
     return tr;
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "utils.h"
-#include <yaml.h>
-#include <regex>
+#include "MissionParser.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <cctype>
+#include <exception>
+#include <thread>
 #include <ros/console.h>
 #include <fstream>
 #include <tuple>
@@ -10,150 +14,48 @@ using namespace Eigen;
 namespace simutils {
 
     void processYamlFile(char *fPath, YamlDescriptor &yamlDescriptor) {
-        FILE *fh = fopen(fPath, "r");
-        yaml_parser_t parser;
-        yaml_event_t event;
-
-        if (!yaml_parser_initialize(&parser)) {
-            std::cout << "Failed to initialize parser!\n" << std::endl;
-        }
-        if (fh == NULL) {
-            std::cout << "Failed to open file!\n" << std::endl;
-        }
-
-        yaml_parser_set_input_file(&parser, fh);
-
-        parseYamlHeader(fPath, yamlDescriptor);
-
-        bool drone_node = false;
-        bool horizon_node = false;
-        bool subgoal_node = false;
-        bool horizons_node = false;
-        bool times_node = false;
-        bool timeset_node = false;
-        bool movingThresholdNode = false;
-        bool hoveringThresholdNode = false;
-
-        vector<double> pos_sequence;
-        int nHorizons;
-        int nDrones;
-        int subgoals;
-        vector<DroneTrajectory> dronesTrajList;
-        vector<double> timeSequence;
-        vector<HorizonTimes> horizonsTimes;
-
-        nHorizons = yamlDescriptor.getHorizons();
-        subgoals = yamlDescriptor.getSubGoals();
-        nDrones = yamlDescriptor.getDrones();
-
-        const std::regex drone_regex("drone(\\d)");
-        const std::regex horizon_regex("horizon(\\d)");
-        const std::regex times_regex("times");
-        const std::regex timeset_regex("timeset(\\d)");
-        std::smatch pieces_match;
-
-        do {
-            if (!yaml_parser_parse(&parser, &event)) {
-                printf("Parser error %d\n", parser.error);
-                exit(EXIT_FAILURE);
-            }
-
-            switch (event.type) {
-                case YAML_SEQUENCE_START_EVENT:
-                    subgoal_node = true;
-                    break;
-
-                case YAML_SEQUENCE_END_EVENT:
-                    subgoal_node = false;
-                    if (timeset_node)
-                        timeset_node = false;
-                    break;
-
-                case YAML_MAPPING_END_EVENT:
-                    if (horizon_node && drone_node) {
-                        horizon_node = false;
-                    } else if (drone_node) {
-                        drone_node = false;
-                    }
-                    break;
+        MissionParser::parseFile(fPath, yamlDescriptor);
+        ROS_DEBUG_STREAM("Finished parsing the yaml body information");
+    }
 
-                case YAML_SCALAR_EVENT:
-                    char *c = (char *) event.data.scalar.value;
-                    string s = std::string(c);
-                    if (std::regex_match(s, pieces_match, drone_regex)) {
-                        drone_node = true;
-                        continue;
-                    } else if (std::regex_match(s, pieces_match, horizon_regex)) {
-                        horizon_node = true;
-                        continue;
-                    } else if (std::regex_match(s, times_regex)) {
-                        times_node = true;
-                        continue;
-                    } else if (std::regex_match(s, pieces_match, timeset_regex)) {
-                        timeset_node = true;
-                        continue;
-                    } else if(s.compare("movingThreshold") == 0) {
-                        movingThresholdNode = true;
-                        continue;
-                    } else if(s.compare("hoveringThreshold") == 0) {
-                        hoveringThresholdNode = true;
-                        continue;
-                    }
-                    if(movingThresholdNode) {
-                        yamlDescriptor.setMovingThreshold(std::stod(s));
-                        movingThresholdNode = false;
-                    }
-                    if(hoveringThresholdNode) {
-                        yamlDescriptor.setHoveringThreshold(std::stod(s));
-                        hoveringThresholdNode = false;
-                    }
-                    if (timeset_node && times_node) {
-                        timeSequence.push_back(std::stod(s));
-                    }
-                    if (horizon_node && subgoal_node) {
-                        pos_sequence.push_back(std::stod(s));
-                    }
-                    break;
-            }
-            if (event.type != YAML_STREAM_END_EVENT) {
-                yaml_event_delete(&event);
+    vector<Obstacle> readObstacleConfig(const string &fPath) {
+        ROS_DEBUG_STREAM("Obstacle config path: " << fPath);
+        string buf = MissionParser::readFile(fPath);
+        vector<Obstacle> obsList;
+        vector<double> values;
+        const char *cur = buf.data();
+        int lineNo = 0;
+        MissionParser::Line line;
+        while (MissionParser::nextLine(cur, buf.data() + buf.size(), lineNo, line)) {
+            //every obstacle key starts a new obstacle, the following keys describe it
+            if (MissionParser::keyEquals(line, "obstacle")) {
+                Obstacle ob;
+                ob.center = Vector3d::Zero();
+                ob.height = ob.width = ob.length = 0;
+                obsList.push_back(ob);
+                continue;
             }
-        } while (event.type != YAML_STREAM_END_EVENT);
-        yaml_event_delete(&event);
-                
-        for(int h=0;h<nHorizons;h++) {
-            HorizonTimes horzTimes;
-            for(int i=0;i<subgoals-1;i++) {
-                double t = timeSequence[i + h*(subgoals-1)];
-                horzTimes.times.push_back(t);
+            if (obsList.empty()) {
+                continue;
             }
-            horizonsTimes.push_back(horzTimes);
-        }
-
-        for(int i=0;i<nDrones;i++) {
-            DroneTrajectory droneTr;
-            for(int h=0;h<nHorizons;h++) {
-                Trajectory tr;
-                int startIdx = 3*subgoals*nHorizons*i + 3*subgoals*h;
-                int endIdx = startIdx + 3*subgoals;
-                Vector3d p;
-                for(int idx=startIdx;idx<endIdx;idx++) {
-                    int dim = idx%3;
-                    if(dim <= 2) {
-                        p[dim] = pos_sequence[idx];
-                    }
-                    if(dim == 2) {
-                        tr.pos.push_back(p);
-                    }
+            Obstacle &ob = obsList.back();
+            if (MissionParser::keyEquals(line, "center")) {
+                values.clear();
+                MissionParser::parseNumbers(line, values);
+                if (values.size() != 3) {
+                    MissionParser::fail(line, "expected a center of three coordinates");
                 }
-                droneTr.horzTrajList.push_back(tr);
+                ob.center = Vector3d(values[0], values[1], values[2]);
+            } else if (MissionParser::keyEquals(line, "height")) {
+                ob.height = MissionParser::parseNumber(line);
+            } else if (MissionParser::keyEquals(line, "width")) {
+                ob.width = MissionParser::parseNumber(line);
+            } else if (MissionParser::keyEquals(line, "length")) {
+                ob.length = MissionParser::parseNumber(line);
             }
-            dronesTrajList.push_back(droneTr);
         }
-
-        yamlDescriptor.setDronesTrajectories(dronesTrajList);
-        yamlDescriptor.setTimesArray(horizonsTimes);
-        ROS_DEBUG_STREAM("Finished parsing the yaml body information");
+        ROS_DEBUG_STREAM("Loaded " << obsList.size() << " obstacles");
+        return obsList;
     }
 
     std::vector<double> loadTimesFromFile(ros::NodeHandle &nh) {
@@ -175,28 +77,86 @@ namespace simutils {
     }
 
     std::vector<Trajectory> loadTrajectoriesFromFile(int n_drones, ros::NodeHandle &nh, const string filePath) {
-        std::vector<Trajectory> trajList;
-        std::string prefix;
-        prefix = "pos_";
-        for (int i = 0; i < n_drones; i++) {
-            std::stringstream ss;
-            ss << filePath << prefix << i << ".txt";
-            ROS_DEBUG_STREAM("Loading trajectories from file " << ss.str());
-            std::ifstream posStream(ss.str());
-            std::string posLine;
-            double x, y, z;
-            Trajectory traj;
-            while (posStream >> x >> y >> z) {
-                Eigen::Vector3d pos;
-                pos << x, y, z;
-                traj.pos.push_back(pos);
+        return loadTrajectoriesFromFile(n_drones, filePath);
+    }
+
+    vector<Trajectory> loadTrajectoriesFromFile(int n_drones, const string &trajDir) {
+        auto start = std::chrono::steady_clock::now();
+        vector<Trajectory> trajList(n_drones);
+        vector<size_t> sizes(n_drones);
+        int nLoaders = min<int>(n_drones, max(1u, thread::hardware_concurrency()));
+        vector<future<void> > loaders;
+        for (int t = 0; t < nLoaders; t++) {
+            loaders.push_back(async(launch::async, [&trajList, &sizes, &trajDir, t, nLoaders, n_drones]() {
+                for (int i = t; i < n_drones; i += nLoaders) {
+                    std::stringstream ss;
+                    ss << trajDir << "pos_" << i << ".txt";
+                    trajList[i] = loadTrajectoryFile(ss.str(), sizes[i]);
+                }
+            }));
+        }
+        //every loader is waited for before an error is passed on, they write into trajList
+        exception_ptr error;
+        for (future<void> &loader : loaders) {
+            try {
+                loader.get();
+            }
+            catch (...) {
+                if (!error) {
+                    error = current_exception();
+                }
             }
-            trajList.push_back(traj);
         }
-        ROS_DEBUG_STREAM("Trajectories loaded from file");
+        if (error) {
+            rethrow_exception(error);
+        }
+        size_t bytes = 0;
+        for (size_t size : sizes) {
+            bytes += size;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ROS_INFO_STREAM("Loaded the trajectories of " << n_drones << " drones (" << bytes / 1e6 << " MB) in "
+                                                      << secs * 1000 << " ms, " << bytes / 1e6 / secs << " MB/s");
         return trajList;
     }
 
+    Trajectory loadTrajectoryFile(const string &fPath, size_t &size) {
+        ROS_DEBUG_STREAM("Loading trajectories from file " << fPath);
+        MappedFile file(fPath);
+        size = file.size();
+        const char *p = file.begin();
+        const char *e = file.end();
+        Trajectory traj;
+        //one position per line. Counting them first allocates the samples once
+        size_t nLines = count(p, e, '\n');
+        if (p < e && *(e - 1) != '\n') {
+            nLines++;
+        }
+        traj.pos.reserve(nLines);
+        double xyz[3];
+        int dim = 0;
+        while (p < e) {
+            while (p < e && isspace((unsigned char) *p)) p++;
+            if (p == e) {
+                break;
+            }
+            const char *q = p;
+            while (q < e && !isspace((unsigned char) *q)) q++;
+            if (!MissionParser::parseDouble(p, q, xyz[dim])) {
+                throw runtime_error(fPath + ": expected a number but found \"" + string(p, q) + "\"");
+            }
+            if (++dim == 3) {
+                traj.pos.push_back(Vector3d(xyz[0], xyz[1], xyz[2]));
+                dim = 0;
+            }
+            p = q;
+        }
+        if (dim != 0) {
+            ROS_WARN_STREAM(fPath << " ends with an incomplete position. Ignored");
+        }
+        return traj;
+    }
+
     int getGazeboModelId(std::vector<std::string> modelNames, string elementName) {
         for(int i=0;i<modelNames.size();i++) {
             std::string key = modelNames[i];
@@ -207,87 +167,18 @@ namespace simutils {
         return -1;
     }
 
-    void parseYamlHeader(char *fPath, YamlDescriptor &yamlDescriptor) {
-        FILE *fh = fopen(fPath, "r");
-        yaml_parser_t parser;
-        yaml_event_t event;
-        if (!yaml_parser_initialize(&parser)) {
-            std::cout << "Failed to initialize parser!\n" << std::endl;
+    vector<Trajectory> getHorizonTrajetories(int horizonId, const YamlDescriptor &yamlDescriptor) {
+        if (horizonId < 0 || horizonId >= yamlDescriptor.getHorizons()) {
+            throw range_error("Horizon " + to_string(horizonId) + " is not in the mission");
         }
-        if (fh == NULL) {
-            std::cout << "Failed to open file!\n" << std::endl;
-        }
-        yaml_parser_set_input_file(&parser, fh);
-        bool nDronesNode;
-        bool nHorizonsNode;
-        bool nSubGoalsNode;
-        int nDrones;
-        int nHorizons;
-        int nSubgoals;
-
-        do {
-            if (!yaml_parser_parse(&parser, &event)) {
-                printf("Parser error %d\n", parser.error);
-                exit(EXIT_FAILURE);
-            }
-
-            switch (event.type) {
-                case YAML_SCALAR_EVENT:
-                    char *c = (char *) event.data.scalar.value;
-                    string s = std::string(c);
-
-                    if(s.compare("drones") == 0) {
-                        nDronesNode = false;
-                        continue;
-                    }
-                    else if(s.compare("horizons") == 0) {
-                        nHorizonsNode = true;
-                        continue;
-                    }
-                    else if(s.compare("subgoals") == 0) {
-                        nSubGoalsNode = true;
-                        continue;
-                    }
-                    if (nSubGoalsNode) {
-                        ROS_DEBUG_STREAM("nSubGoalsNode "<<s);
-                        nSubgoals = std::stoi(s);
-                        nSubGoalsNode = false;
-                    }
-                    else if (nHorizonsNode) {
-                        ROS_DEBUG_STREAM("nHorizonsNode "<<s);
-                        nHorizons = std::stoi(s);
-                        nHorizonsNode = false;
-                    }
-                    else if(nDronesNode) {
-                        ROS_DEBUG_STREAM("nDronesNode "<<s);
-                        nDrones = std::stoi(s);
-                        nDronesNode = false;
-                    }
-                    break;
-            }
-            if (event.type != YAML_STREAM_END_EVENT) {
-                yaml_event_delete(&event);
-            }
-        } while (event.type != YAML_STREAM_END_EVENT);
-
-        yamlDescriptor.setDrones(5);
-        yamlDescriptor.setHorizons(nHorizons);
-        yamlDescriptor.setSubGoals(nSubgoals);
-
-        yaml_event_delete(&event);
-        ROS_DEBUG_STREAM("Done parsing the yaml header information");
-
-    }
-
-    vector<Trajectory> getHorizonTrajetories(int horizonId, YamlDescriptor yamlDescriptor) {
-        vector<DroneTrajectory> droneTrajectories = yamlDescriptor.getdroneTrajectories();
+        const vector<DroneTrajectory> &droneTrajectories = yamlDescriptor.getdroneTrajectories();
+        const vector<double> &times = yamlDescriptor.getTimesArray()[horizonId].times;
         vector<Trajectory> trs;
+        trs.reserve(yamlDescriptor.getDrones());
         for(int i=0;i<yamlDescriptor.getDrones();i++) {
-            DroneTrajectory dtr = droneTrajectories[i];
-            Trajectory tr = dtr.horzTrajList[horizonId];
-            vector<HorizonTimes> hz_t = yamlDescriptor.getTimesArray(); 
-            tr.tList = hz_t[horizonId].times;
-            trs.push_back(tr);
+            Trajectory tr = droneTrajectories[i].horzTrajList[horizonId];
+            tr.tList = times;
+            trs.push_back(move(tr));
         }
         return trs;
     }
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "MissionCheckpoint.h"
+#include "TrajectoryQueue.h"
+#include "testutils.h"
+
+using namespace std;
+using namespace Eigen;
+
+const string fPath = "/tmp/swarmsim_checkpoint_test.bin";
+
+SwarmCheckpoint getCheckpoint() {
+    SwarmCheckpoint checkpoint;
+    checkpoint.mission = "/tmp/goals.yaml";
+    checkpoint.horizonId = 4;
+    checkpoint.nHorizons = 6;
+    for (int k = 0; k < 3; k++) {
+        DroneCheckpoint drone;
+        drone.home = Vector3d(2 * k, 0, 0.1);
+        drone.trajectoryId = 2;
+        drone.execPointer = 40 + k;
+        for (int n : {300, 250}) {
+            //the second trajectory of drone 1 has no derivatives
+            bool derivatives = n == 300 || k != 1;
+            shared_ptr<Trajectory> tr = testutils::getLine(Vector3d(k, 0, 2.5), Vector3d(0, 0.1, 0), n,
+                                                           derivatives ? testutils::WithVelocityAndAcceleration
+                                                                       : testutils::PositionOnly,
+                                                           Vector3d(0, 1, 0));
+            tr->tList = {3, 3};
+            drone.trajectories.push_back(tr);
+        }
+        checkpoint.drones.push_back(drone);
+    }
+    return checkpoint;
+}
+
+TEST(MissionCheckpointTestSuite, testRoundTrip) {
+    SwarmCheckpoint written = getCheckpoint();
+    MissionCheckpoint::write(fPath, written);
+    SwarmCheckpoint read = MissionCheckpoint::read(fPath);
+    ASSERT_EQ(read.mission, written.mission);
+    ASSERT_EQ(read.horizonId, 4);
+    ASSERT_EQ(read.nHorizons, 6);
+    ASSERT_EQ(read.drones.size(), 3);
+    for (int k = 0; k < 3; k++) {
+        const DroneCheckpoint &a = written.drones[k];
+        const DroneCheckpoint &b = read.drones[k];
+        ASSERT_EQ(b.home, a.home);
+        ASSERT_EQ(b.trajectoryId, a.trajectoryId);
+        ASSERT_EQ(b.execPointer, a.execPointer);
+        ASSERT_EQ(b.trajectories.size(), a.trajectories.size());
+        for (int j = 0; j < a.trajectories.size(); j++) {
+            ASSERT_EQ(b.trajectories[j]->pos, a.trajectories[j]->pos);
+            ASSERT_EQ(b.trajectories[j]->vel, a.trajectories[j]->vel);
+            ASSERT_EQ(b.trajectories[j]->acc, a.trajectories[j]->acc);
+            ASSERT_EQ(b.trajectories[j]->tList, a.trajectories[j]->tList);
+        }
+    }
+    remove(fPath.c_str());
+}
+
+TEST(MissionCheckpointTestSuite, testCorruptCheckpoint) {
+    MissionCheckpoint::write(fPath, getCheckpoint());
+    {
+        fstream f(fPath.c_str(), ios::in | ios::out | ios::binary);
+        f.seekp(200);
+        f.put('x');
+    }
+    ASSERT_THROW(MissionCheckpoint::read(fPath), runtime_error);
+    remove(fPath.c_str());
+    ASSERT_THROW(MissionCheckpoint::read(fPath), runtime_error);
+}
+
+/**
+ * the progress a drone resumes from, as Drone::restore and Drone::getCheckpoint hand it to its queue
+ */
+TEST(MissionCheckpointTestSuite, testRestoreQueue) {
+    MissionCheckpoint::write(fPath, getCheckpoint());
+    const DroneCheckpoint saved = MissionCheckpoint::read(fPath).drones[1];
+    remove(fPath.c_str());
+
+    TrajectoryQueue queue;
+    queue.restore(saved);
+    DroneCheckpoint restored;
+    queue.getCheckpoint(restored);
+    ASSERT_EQ(restored.trajectoryId, saved.trajectoryId);
+    ASSERT_EQ(restored.execPointer, saved.execPointer);
+    ASSERT_EQ(restored.trajectories, saved.trajectories);
+
+    //execution continues at the saved sample, then moves on to the queued trajectory
+    TrajectoryState reference;
+    ASSERT_TRUE(queue.sample(100, 10, reference));
+    ASSERT_EQ(queue.getExecPointer(), saved.execPointer);
+    ASSERT_LT((reference.pos - saved.trajectories[0]->pos[saved.execPointer]).norm(), 1e-9);
+    ASSERT_TRUE(queue.sample(100 + (299 - saved.execPointer + 5) / 10.0, 10, reference));
+    ASSERT_EQ(queue.getTrajectoryId(), saved.trajectoryId + 1);
+    ASSERT_EQ(queue.getExecPointer(), 5);
+    ASSERT_EQ(queue.size(), 1);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
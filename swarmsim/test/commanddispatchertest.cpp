@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CommandDispatcher.h"
+
+using namespace std;
+
+/**
+ * polls the status like the control loop does until the command is no longer pending
+ */
+CommandStatus waitFor(CommandDispatcher &dispatcher, int droneId, CommandType type) {
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while (dispatcher.getStatus(droneId, type) == CommandPending && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return dispatcher.getStatus(droneId, type);
+}
+
+TEST(CommandDispatcherTestSuite, testConcurrentCommands) {
+    const int nDrones = 16;
+    CommandDispatcher dispatcher(nDrones, 8);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < nDrones; i++) {
+        ASSERT_EQ(dispatcher.getStatus(i, ArmCommand), CommandIdle);
+        dispatcher.dispatch(i, ArmCommand, []() {
+            this_thread::sleep_for(chrono::milliseconds(50));
+            return true;
+        });
+        ASSERT_EQ(dispatcher.getStatus(i, ArmCommand), CommandPending);
+    }
+    for (int i = 0; i < nDrones; i++) {
+        ASSERT_EQ(waitFor(dispatcher, i, ArmCommand), CommandSucceeded);
+    }
+    //16 calls of 50ms on 8 workers take about 100ms, serially they would take 800ms
+    ASSERT_LT(chrono::steady_clock::now() - start, chrono::milliseconds(500));
+    ASSERT_EQ(dispatcher.getPending(), 0);
+    dispatcher.reset(3, ArmCommand);
+    ASSERT_EQ(dispatcher.getStatus(3, ArmCommand), CommandIdle);
+}
+
+TEST(CommandDispatcherTestSuite, testRetries) {
+    CommandDispatcher dispatcher(2, 2, 3, 0.01);
+    atomic<int> calls(0);
+    dispatcher.dispatch(0, TakeoffCommand, [&calls]() {
+        return ++calls == 3;
+    });
+    ASSERT_EQ(waitFor(dispatcher, 0, TakeoffCommand), CommandSucceeded);
+    ASSERT_EQ(calls, 3);
+
+    //exceptions count as failed attempts
+    atomic<int> failures(0);
+    dispatcher.dispatch(1, LandCommand, [&failures]() -> bool {
+        failures++;
+        throw runtime_error("no service");
+    });
+    ASSERT_EQ(waitFor(dispatcher, 1, LandCommand), CommandFailed);
+    ASSERT_EQ(failures, 3);
+    ASSERT_EQ(dispatcher.getStatus(1, ArmCommand), CommandIdle);
+}
+
+TEST(CommandDispatcherTestSuite, testPerDroneOrder) {
+    CommandDispatcher dispatcher(1, 4, 2, 0.01);
+    mutex orderMutex;
+    vector<int> order;
+    atomic<int> inFlight(0);
+    atomic<bool> overlapped(false);
+    bool failedOnce = false;
+    for (int k = 0; k < 5; k++) {
+        dispatcher.dispatch(0, SetModeCommand, [&, k]() {
+            if (++inFlight > 1) {
+                overlapped = true;
+            }
+            this_thread::sleep_for(chrono::milliseconds(5));
+            bool accepted = true;
+            {
+                lock_guard<mutex> lock(orderMutex);
+                //the retry of the second command must still run before the third one
+                if (k == 1 && !failedOnce) {
+                    failedOnce = true;
+                    accepted = false;
+                } else {
+                    order.push_back(k);
+                }
+            }
+            inFlight--;
+            return accepted;
+        });
+    }
+    ASSERT_EQ(waitFor(dispatcher, 0, SetModeCommand), CommandSucceeded);
+    ASSERT_FALSE(overlapped);
+    ASSERT_EQ(order, vector<int>({0, 1, 2, 3, 4}));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
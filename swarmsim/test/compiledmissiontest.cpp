@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "CompiledMission.h"
+#include "testutils.h"
+
+using namespace std;
+using namespace Eigen;
+
+const string fPath = "/tmp/swarmsim_compiled_mission_test.bin";
+
+void writeMission() {
+    vector<vector<TrajectoryPtr> > plans(3);
+    for (int h = 0; h < 3; h++) {
+        for (int k = 0; k < 2; k++) {
+            //no accelerations, they are written as zeros
+            plans[h].push_back(testutils::getLine(Vector3d(k, h, 0), Vector3d(0, 0, 1), 5 + h,
+                                                  testutils::WithVelocity, Vector3d(k, h, 1)));
+        }
+    }
+    Obstacle ob;
+    ob.center = Vector3d(1, 2, 3);
+    ob.height = 4;
+    ob.width = 5;
+    ob.length = 6;
+    CompiledMission::write(fPath, 100, plans, vector<Obstacle>(1, ob));
+}
+
+TEST(CompiledMissionTestSuite, testRoundTrip) {
+    writeMission();
+    CompiledMission mission(fPath);
+    ASSERT_EQ(mission.getDrones(), 2);
+    ASSERT_EQ(mission.getHorizons(), 3);
+    ASSERT_DOUBLE_EQ(mission.getFrequency(), 100);
+    ASSERT_EQ(mission.getSamples(1, 2), 7);
+
+    Trajectory tr = mission.getTrajectory(1, 2);
+    ASSERT_EQ(tr.pos.size(), 7);
+    ASSERT_EQ(tr.pos[6], Vector3d(1, 2, 6));
+    ASSERT_EQ(tr.vel[6], Vector3d(1, 2, 1));
+    ASSERT_EQ(tr.acc[6], Vector3d::Zero());
+
+    const double *z = mission.getSeries(0, 1, PosZ);
+    ASSERT_EQ((size_t) z % 64, 0);
+    ASSERT_DOUBLE_EQ(z[5], 5);
+
+    vector<Obstacle> obstacles = mission.getObstacles();
+    ASSERT_EQ(obstacles.size(), 1);
+    ASSERT_EQ(obstacles[0].center, Vector3d(1, 2, 3));
+    ASSERT_FLOAT_EQ(obstacles[0].length, 6);
+    ASSERT_THROW(mission.getTrajectory(2, 0), range_error);
+}
+
+TEST(CompiledMissionTestSuite, testTrajectoryView) {
+    writeMission();
+    auto mission = make_shared<const CompiledMission>(fPath);
+    TrajectoryPtr view = CompiledMission::getTrajectoryView(mission, 1, 2);
+    Trajectory copy = mission->getTrajectory(1, 2);
+    ASSERT_EQ(view->pos, copy.pos);
+    ASSERT_EQ(view->vel, copy.vel);
+    ASSERT_EQ(view->acc, copy.acc);
+    //nothing was copied, the samples are read from the mapping
+    ASSERT_EQ(view->pos.data(2), mission->getSeries(1, 2, PosZ));
+    ASSERT_EQ(view->acc.data(0), mission->getSeries(1, 2, AccX));
+
+    //the view keeps the mission mapped
+    mission.reset();
+    remove(fPath.c_str());
+    ASSERT_EQ(view->pos[6], Vector3d(1, 2, 6));
+    ASSERT_EQ(view->vel[6], Vector3d(1, 2, 1));
+    Trajectory owned = *view;
+    view.reset();
+    ASSERT_EQ(owned.pos[6], Vector3d(1, 2, 6));
+}
+
+TEST(CompiledMissionTestSuite, testCorruptedMission) {
+    writeMission();
+    {
+        fstream f(fPath.c_str(), ios::in | ios::out | ios::binary);
+        f.seekp(-8, ios::end);
+        double garbage = 42;
+        f.write((const char *) &garbage, sizeof(garbage));
+    }
+    ASSERT_THROW(CompiledMission mission(fPath), runtime_error);
+    //the layout is still valid, only the checksum detects the change
+    CompiledMission unverified(fPath, false);
+    ASSERT_EQ(unverified.getDrones(), 2);
+    remove(fPath.c_str());
+    ASSERT_THROW(CompiledMission mission(fPath), runtime_error);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include "FlightRecorder.h"
+
+using namespace std;
+
+const string fPath = "/tmp/swarmsim_flight_recorder_test.log";
+
+TEST(FlightRecorderTestSuite, testRoundTrip) {
+    {
+        FlightRecorder recorder(fPath);
+        recorder.recordState(1.0, 3);
+        recorder.recordPlanningEvent(1.5, PlanningCommitted, 2);
+        //setpoints and poses arrive from different threads
+        thread poses([&recorder]() {
+            for (int i = 0; i < 1000; i++) {
+                recorder.recordPose(2.0 + i, 1, Eigen::Vector3d(i, 0, 2));
+            }
+        });
+        for (int i = 0; i < 1000; i++) {
+            recorder.recordSetpoint(2.0 + i, 0, Eigen::Vector3d(i, 1, 2.5), i);
+        }
+        poses.join();
+        ASSERT_EQ(recorder.getDropped(), 0);
+    }
+    vector<FlightRecord> records = FlightRecorder::readLog(fPath);
+    ASSERT_EQ(records.size(), 2002);
+    ASSERT_EQ(records[0].type, SwarmStateRecord);
+    ASSERT_EQ(records[0].value, 3);
+    ASSERT_EQ(records[1].type, PlanningRecord);
+    ASSERT_EQ(records[1].event, PlanningCommitted);
+    ASSERT_EQ(records[1].value, 2);
+    int setpoints = 0;
+    for (const FlightRecord &r : records) {
+        if (r.type == SetpointRecord) {
+            //records of one producer keep their order
+            ASSERT_EQ(r.value, setpoints);
+            ASSERT_DOUBLE_EQ(r.x, setpoints);
+            ASSERT_DOUBLE_EQ(r.z, 2.5);
+            setpoints++;
+        }
+    }
+    ASSERT_EQ(setpoints, 1000);
+    remove(fPath.c_str());
+}
+
+TEST(FlightRecorderTestSuite, testDropWhenFull) {
+    {
+        FlightRecorder recorder(fPath, 4);
+        for (int i = 0; i < 100000; i++) {
+            recorder.recordState(i, 0);
+        }
+        //the writer may keep up with some of them, but not with all
+        ASSERT_GT(recorder.getDropped(), 0);
+    }
+    ASSERT_THROW(FlightRecorder::readLog("/nonexistent/flight.log"), runtime_error);
+    remove(fPath.c_str());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include "FlightRecorder.h"
+#include "SegmentedTrajectory.h"
+#include "SeqlockSlot.h"
+#include "SetpointLoop.h"
+#include "SetpointTick.h"
+#include "StateCounters.h"
+#include "TrackingStats.h"
+#include "TrajectoryArena.h"
+#include "TrajectoryQueue.h"
+
+using namespace std;
+
+namespace {
+    //heap allocations made by the calling thread
+    thread_local uint64_t allocations = 0;
+}
+
+void *operator new(size_t size) {
+    allocations++;
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+namespace {
+    struct PoseSample {
+        double position[3];
+    };
+
+    /**
+     * Drone::executeTrajectory without its publish, on the code the drone runs: the setpoint
+     * tick over the trajectory queue, the latest pose, the tracking error and the flight
+     * recorder. Three horizons are queued, so the ticks include the handovers between them.
+     */
+    class TickFixture {
+    public:
+        explicit TickFixture(bool feedforward = false) : recorder(logPath()) {
+            setpoint.feedforward = feedforward;
+            auto arena = make_shared<TrajectoryArena>();
+            for (int h = 0; h < 3; h++) {
+                auto tr = make_shared<Trajectory>();
+                tr->allocate(301, arena);
+                for (int i = 0; i <= 300; i++) {
+                    double t = (300 * h + i) / 100.0;
+                    tr->pos[i] = Eigen::Vector3d(5 * cos(0.5 * t), 5 * sin(0.5 * t), 2);
+                    tr->vel[i] = Eigen::Vector3d(-2.5 * sin(0.5 * t), 2.5 * cos(0.5 * t), 0);
+                    tr->acc[i] = Eigen::Vector3d::Zero();
+                }
+                queue.push(tr);
+            }
+            counters.transition(-1, States::Autonomous);
+        }
+
+        ~TickFixture() {
+            remove(logPath().c_str());
+        }
+
+        double tick(double now) {
+            if (!setpoint.update(queue, now, 100, home, ros::Time(now))) {
+                counters.transition(States::Autonomous, States::Reached);
+            }
+            //stands in for the position callback
+            PoseSample sample;
+            for (int axis = 0; axis < 3; axis++) {
+                sample.position[axis] = setpoint.waypoint[axis] + 0.01;
+            }
+            pose.store(sample);
+            PoseSample latest;
+            if (pose.load(latest)) {
+                tracking.add(Eigen::Vector3d(latest.position[0], latest.position[1], latest.position[2])
+                             - setpoint.waypoint);
+            }
+            recorder.recordSetpoint(now, 0, setpoint.waypoint, queue.getExecPointer());
+            return tracking.last.norm();
+        }
+
+        const SetpointTick &getSetpoint() {
+            return setpoint;
+        }
+
+        int getTrajectoryId() {
+            return queue.getTrajectoryId();
+        }
+
+    private:
+        TrajectoryQueue queue;
+        SetpointTick setpoint;
+        Eigen::Vector3d home{1, 2, 0};
+        SeqlockSlot<PoseSample> pose;
+        TrackingStats tracking;
+        StateCounters counters;
+        FlightRecorder recorder;
+
+        static string logPath() {
+            return "/tmp/swarmsim_hotpath_test.log";
+        }
+    };
+}
+
+TEST(HotPathTestSuite, testControlTick) {
+    for (bool feedforward : {false, true}) {
+        TickFixture fixture(feedforward);
+        fixture.tick(100);
+        uint64_t before = allocations;
+        double error = 0;
+        for (int n = 0; n < 2000; n++) {
+            error += fixture.tick(100 + n / 250.0);
+        }
+        ASSERT_EQ(allocations - before, 0);
+        ASSERT_GT(error, 0);
+        //moved on to the last horizon
+        ASSERT_EQ(fixture.getTrajectoryId(), 2);
+    }
+    //the horizons carry velocities and accelerations, so only the yaw is left to the autopilot
+    TickFixture fixture(true);
+    fixture.tick(100.5);
+    const SetpointTick &setpoint = fixture.getSetpoint();
+    ASSERT_EQ(setpoint.targetMsg.type_mask,
+              mavros_msgs::PositionTarget::IGNORE_YAW | mavros_msgs::PositionTarget::IGNORE_YAW_RATE);
+    ASSERT_NEAR(setpoint.targetMsg.position.x, setpoint.reference.pos[0] - 1, 1e-9);
+    ASSERT_NEAR(setpoint.targetMsg.velocity.y, setpoint.reference.vel[1], 1e-9);
+}
+
+TEST(HotPathTestSuite, testExecutorTick) {
+    Trajectory tr;
+    tr.pos.resize(1001);
+    tr.vel.resize(1001);
+    for (int i = 0; i <= 1000; i++) {
+        double t = i / 100.0;
+        tr.pos[i] = Eigen::Vector3d(5 * cos(0.5 * t), 5 * sin(0.5 * t), 2);
+        tr.vel[i] = Eigen::Vector3d(-2.5 * sin(0.5 * t), 2.5 * cos(0.5 * t), 0);
+    }
+    SegmentSchedule schedule;
+    uint64_t setup = allocations;
+    for (int id = 0; id < 2; id++) {
+        SegmentedTrajectory segmented = SegmentedTrajectory::fit(tr, 100, 0.01);
+        segmented.trajectoryId = id;
+        segmented.start = 10 * id;
+        schedule.insert(segmented);
+    }
+    //receiving a horizon does allocate, which shows the counter at work
+    ASSERT_GT(allocations - setup, 0);
+
+    //sampling, including the handover to the second horizon, allocates nothing
+    uint64_t before = allocations;
+    TrajectoryState state;
+    for (int n = 0; n < 2000; n++) {
+        ASSERT_TRUE(schedule.sample(n / 100.0, state));
+    }
+    ASSERT_EQ(allocations - before, 0);
+    ASSERT_EQ(schedule.size(), 1);
+}
+
+TEST(HotPathTestSuite, testSetpointLoop) {
+    TickFixture fixture;
+    atomic<int> ticks(0);
+    atomic<uint64_t> tickAllocations(0);
+    SetpointLoop loop(500, [&]() {
+        uint64_t before = allocations;
+        fixture.tick(100 + ticks / 250.0);
+        tickAllocations += allocations - before;
+        ticks++;
+    });
+    loop.start();
+    this_thread::sleep_for(chrono::milliseconds(200));
+    loop.stop();
+    ASSERT_GT(ticks, 20);
+    ASSERT_EQ(tickAllocations, 0);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
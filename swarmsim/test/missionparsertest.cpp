@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <fstream>
+#include <cstdio>
+#include "MissionParser.h"
+#include "IndexedMission.h"
+#include "utils.h"
+
+using namespace std;
+
+/**
+ * builds a mission where every subgoal encodes its drone, horizon and index
+ */
+string getMission(int nDrones, int nHorizons, int nSubgoals) {
+    stringstream ss;
+    ss << "#Header (Meta information)\n";
+    ss << "horizons: " << nHorizons << "\nsubgoals: " << nSubgoals << "\ndrones: " << nDrones << "\n\n";
+    ss << "times:\n";
+    for (int h = 0; h < nHorizons; h++) {
+        ss << "  timeset" << h << ": [";
+        for (int i = 0; i < nSubgoals - 1; i++) {
+            ss << (i > 0 ? ", " : "") << h + 1;
+        }
+        ss << "]\n";
+    }
+    for (int k = 0; k < nDrones; k++) {
+        ss << "\ndrone" << k << ":\n";
+        for (int h = 0; h < nHorizons; h++) {
+            ss << "  horizon" << h << ": #comment\n";
+            for (int i = 0; i < nSubgoals; i++) {
+                ss << "    subgoal: [" << k << ", " << h << ", " << i << ".5]\n";
+            }
+        }
+    }
+    ss << "\n  movingThreshold: 2\n  hoveringThreshold: 1.5";
+    return ss.str();
+}
+
+void parse(const string &mission, YamlDescriptor &yamlDescriptor) {
+    MissionParser::parse(mission.data(), mission.data() + mission.size(), yamlDescriptor);
+}
+
+TEST(MissionParserTestSuite, testMoreThanNineDronesAndHorizons) {
+    YamlDescriptor yamlDescriptor;
+    parse(getMission(12, 11, 4), yamlDescriptor);
+    ASSERT_EQ(yamlDescriptor.getDrones(), 12);
+    ASSERT_EQ(yamlDescriptor.getHorizons(), 11);
+    ASSERT_EQ(yamlDescriptor.getSubGoals(), 4);
+    vector<DroneTrajectory> drones = yamlDescriptor.getdroneTrajectories();
+    ASSERT_EQ(drones.size(), 12);
+    const Trajectory &tr = drones[11].horzTrajList[10];
+    ASSERT_EQ(tr.pos.size(), 4);
+    ASSERT_EQ(tr.pos[3], Eigen::Vector3d(11, 10, 3.5));
+    vector<HorizonTimes> times = yamlDescriptor.getTimesArray();
+    ASSERT_EQ(times.size(), 11);
+    ASSERT_EQ(times[10].times, vector<double>(3, 11));
+    ASSERT_DOUBLE_EQ(yamlDescriptor.getMovingThreshold(), 2);
+    ASSERT_DOUBLE_EQ(yamlDescriptor.getHoveringThreshold(), 1.5);
+}
+
+TEST(MissionParserTestSuite, testMultiLineSequence) {
+    YamlDescriptor yamlDescriptor;
+    parse("horizons: 1\nsubgoals: 2\ndrones: 1\ntimes:\n  timeset0: [\n    4]\n"
+          "drone0:\n  horizon0:\n    subgoal: [1,\n 2, 3]\n    subgoal: [-1e1, 2, 3]\n", yamlDescriptor);
+    Trajectory tr = yamlDescriptor.getdroneTrajectories()[0].horzTrajList[0];
+    ASSERT_EQ(tr.pos.size(), 2);
+    ASSERT_EQ(tr.pos[0], Eigen::Vector3d(1, 2, 3));
+    ASSERT_EQ(tr.pos[1], Eigen::Vector3d(-10, 2, 3));
+    ASSERT_EQ(yamlDescriptor.getTimesArray()[0].times, vector<double>(1, 4));
+}
+
+TEST(MissionParserTestSuite, testMalformedMission) {
+    YamlDescriptor yamlDescriptor;
+    //drone1 is missing
+    string mission = getMission(3, 2, 3);
+    size_t drone1 = mission.find("drone1:");
+    mission.replace(drone1, 6, "drone5");
+    ASSERT_THROW(parse(mission, yamlDescriptor), runtime_error);
+    //not a number
+    ASSERT_THROW(parse("horizons: 1\ntimes:\n  timeset0: [3, x]\n", yamlDescriptor), runtime_error);
+    //subgoal without a horizon
+    ASSERT_THROW(parse("drone0:\n  subgoal: [1, 2, 3]\n", yamlDescriptor), runtime_error);
+    ASSERT_THROW(MissionParser::parseFile("/nonexistent/mission.yaml", yamlDescriptor), runtime_error);
+}
+
+TEST(MissionParserTestSuite, testIndexedMission) {
+    string fPath = "/tmp/swarmsim_indexed_mission_test.yaml";
+    {
+        ofstream out(fPath.c_str());
+        out << getMission(12, 11, 4);
+    }
+    IndexedMission mission(fPath, 1);
+    ASSERT_EQ(mission.getDrones(), 12);
+    ASSERT_EQ(mission.getHorizons(), 11);
+    ASSERT_DOUBLE_EQ(mission.getHoveringThreshold(), 1.5);
+    ASSERT_EQ(mission.getCachedHorizons(), 0);
+
+    vector<Trajectory> trs = mission.getHorizon(10);
+    ASSERT_EQ(trs.size(), 12);
+    ASSERT_EQ(trs[11].pos.size(), 4);
+    ASSERT_EQ(trs[11].pos[3], Eigen::Vector3d(11, 10, 3.5));
+    ASSERT_EQ(trs[11].tList, vector<double>(3, 11));
+    ASSERT_EQ(mission.getCachedHorizons(), 1);
+
+    trs = mission.getHorizon(3);
+    ASSERT_EQ(trs[5].pos[0], Eigen::Vector3d(5, 3, 0.5));
+    //horizon 3 and the lookahead horizon 4
+    ASSERT_EQ(mission.getCachedHorizons(), 2);
+    ASSERT_THROW(mission.getHorizon(11), range_error);
+
+    //a malformed subgoal of the last horizon is found before the first one is planned
+    {
+        string malformed = getMission(2, 3, 2);
+        malformed.replace(malformed.rfind("subgoal: [1, 2, 1.5]"), 20, "subgoal: [1, 2]");
+        ofstream out(fPath.c_str());
+        out << malformed;
+    }
+    ASSERT_THROW(IndexedMission(fPath, 1), runtime_error);
+    remove(fPath.c_str());
+}
+
+TEST(MissionParserTestSuite, testLoadTrajectoryFile) {
+    double val;
+    ASSERT_TRUE(MissionParser::parseDouble("-12.50", "-12.50" + 6, val));
+    ASSERT_DOUBLE_EQ(val, -12.5);
+    ASSERT_TRUE(MissionParser::parseDouble("2.5e-1", "2.5e-1" + 6, val));
+    ASSERT_DOUBLE_EQ(val, 0.25);
+    ASSERT_FALSE(MissionParser::parseDouble("1.2.3", "1.2.3" + 5, val));
+
+    string fPath = "/tmp/swarmsim_pos_test.txt";
+    {
+        ofstream out(fPath.c_str());
+        //tab separated like the recorded trajectories, without a newline at the end
+        out << "5\t8\t3\n5.5 8 3.25\r\n6\t-1e1\t3";
+    }
+    size_t size;
+    Trajectory tr = simutils::loadTrajectoryFile(fPath, size);
+    ASSERT_EQ(size, 26);
+    ASSERT_EQ(tr.pos.size(), 3);
+    ASSERT_EQ(tr.pos[1], Eigen::Vector3d(5.5, 8, 3.25));
+    ASSERT_EQ(tr.pos[2], Eigen::Vector3d(6, -10, 3));
+    remove(fPath.c_str());
+    ASSERT_THROW(simutils::loadTrajectoryFile(fPath, size), runtime_error);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "Partitioner.h"
+
+using namespace std;
+using namespace Eigen;
+
+Trajectory getLineWpts(Vector3d start, Vector3d end) {
+    Trajectory tr;
+    tr.pos.push_back(start);
+    tr.pos.push_back((start + end) / 2);
+    tr.pos.push_back(end);
+    tr.tList.push_back(3);
+    tr.tList.push_back(3);
+    return tr;
+}
+
+TEST(PartitionerTestSuite, testSeparateClusters) {
+    Partitioner partitioner(10, 0.5);
+    vector<Trajectory> wpts;
+    wpts.push_back(getLineWpts(Vector3d(1, 1, 2), Vector3d(3, 1, 2)));
+    wpts.push_back(getLineWpts(Vector3d(1, 3, 2), Vector3d(3, 3, 2)));
+    wpts.push_back(getLineWpts(Vector3d(51, 1, 2), Vector3d(53, 1, 2)));
+    Partition p = partitioner.partition(wpts);
+    ASSERT_EQ(p.clusters.size(), 2);
+    ASSERT_EQ(p.clusterOf[0], p.clusterOf[1]);
+    ASSERT_NE(p.clusterOf[0], p.clusterOf[2]);
+    ASSERT_TRUE(p.boundaryPairs.empty());
+}
+
+TEST(PartitionerTestSuite, testBoundaryPairs) {
+    Partitioner partitioner(10, 0.5);
+    vector<Trajectory> wpts;
+    //centers fall in neighbouring cells but the regions meet at x = 10
+    wpts.push_back(getLineWpts(Vector3d(2, 1, 2), Vector3d(10, 1, 2)));
+    wpts.push_back(getLineWpts(Vector3d(10.2, 1, 2), Vector3d(18, 1, 2)));
+    Partition p = partitioner.partition(wpts);
+    ASSERT_EQ(p.clusters.size(), 2);
+    ASSERT_EQ(p.boundaryPairs.size(), 1);
+    ASSERT_EQ(p.boundaryPairs[0], make_pair(0, 1));
+}
+
+TEST(PartitionerTestSuite, testConflicts) {
+    Partitioner partitioner(10, 0.5);
+    vector<Trajectory> wpts;
+    wpts.push_back(getLineWpts(Vector3d(0, 0, 2), Vector3d(4, 0, 2)));
+    wpts.push_back(getLineWpts(Vector3d(4, 0, 2), Vector3d(0, 0, 2)));
+    wpts.push_back(getLineWpts(Vector3d(0, 5, 2), Vector3d(4, 5, 2)));
+    vector<TrajectoryPtr> trajs;
+    for (const Trajectory &tr : wpts) {
+        trajs.push_back(make_shared<const Trajectory>(tr));
+    }
+    Partition p = partitioner.partition(wpts);
+    vector<pair<int, int> > conflicts = partitioner.findConflicts(p.clusters[p.clusterOf[0]], p, trajs);
+    ASSERT_EQ(conflicts.size(), 1);
+    ASSERT_EQ(conflicts[0], make_pair(0, 1));
+    ASSERT_NEAR(Partitioner::minDistance(wpts[0], wpts[2]), 5, 1e-9);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include "TrajectoryRegistry.h"
+#include "testutils.h"
+
+using namespace std;
+using namespace Eigen;
+
+const string name = "/swarmsim_registry_test";
+
+/**
+ * every sample of the plan for horizon h is at x = h, so a torn read shows up as mixed values
+ */
+vector<TrajectoryPtr> getPlan(int horizonId, int nDrones, int nSamples) {
+    vector<TrajectoryPtr> plan;
+    for (int k = 0; k < nDrones; k++) {
+        plan.push_back(testutils::getLine(Vector3d(horizonId, k, 0), Vector3d(0, 0, 1), nSamples,
+                                          testutils::WithVelocityAndAcceleration, Vector3d(horizonId, 0, 0),
+                                          Vector3d(horizonId, 0, 0)));
+    }
+    return plan;
+}
+
+TEST(TrajectoryRegistryTestSuite, testPublishAndRead) {
+    TrajectoryRegistry writer(name, 3, 200, 100);
+    TrajectoryRegistry reader(name);
+    ASSERT_EQ(reader.getDrones(), 3);
+    ASSERT_EQ(reader.getCapacity(), 200);
+    ASSERT_EQ(reader.getFrequency(), 100);
+
+    int horizonId;
+    Trajectory tr;
+    ASSERT_FALSE(reader.read(0, horizonId, tr));
+    writer.publish(2, getPlan(2, 3, 150));
+    ASSERT_EQ(reader.getGeneration(), 1);
+    ASSERT_TRUE(reader.read(1, horizonId, tr));
+    ASSERT_EQ(horizonId, 2);
+    ASSERT_EQ(tr.pos.size(), 150);
+    ASSERT_EQ(tr.pos[10], Vector3d(2, 1, 10));
+    ASSERT_EQ(tr.vel[10], Vector3d(2, 0, 0));
+
+    //longer trajectories are cut at the capacity
+    writer.publish(3, getPlan(3, 3, 250));
+    ASSERT_TRUE(reader.read(2, horizonId, tr));
+    ASSERT_EQ(tr.pos.size(), 200);
+    ASSERT_THROW(reader.read(3, horizonId, tr), range_error);
+}
+
+TEST(TrajectoryRegistryTestSuite, testConcurrentReads) {
+    TrajectoryRegistry writer(name, 2, 1000, 100);
+    writer.publish(0, getPlan(0, 2, 1000));
+    atomic<bool> done(false);
+    thread readerThread([&done]() {
+        TrajectoryRegistry reader(name);
+        int horizonId;
+        Trajectory tr;
+        int reads = 0;
+        while (!done || reads == 0) {
+            ASSERT_TRUE(reader.read(reads % 2, horizonId, tr));
+            for (const Vector3d &p : tr.pos) {
+                ASSERT_EQ(p[0], horizonId);
+            }
+            reads++;
+        }
+    });
+    for (int h = 1; h < 2000; h++) {
+        writer.publish(h, getPlan(h, 2, 1000));
+    }
+    done = true;
+    readerThread.join();
+}
+
+TEST(TrajectoryRegistryTestSuite, testMissingRegistry) {
+    ASSERT_THROW(TrajectoryRegistry reader("/swarmsim_registry_missing"), runtime_error);
+    {
+        TrajectoryRegistry writer(name, 1, 10, 100);
+    }
+    //the writer removes the registry when it goes away
+    ASSERT_THROW(TrajectoryRegistry reader(name), runtime_error);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "SegmentedTrajectory.h"
+
+using namespace std;
+
+namespace {
+    //a 10s climbing circle sampled at 100Hz, with the velocities the solver would provide
+    Trajectory makeCircle(bool withVelocity) {
+        Trajectory tr;
+        tr.pos.resize(1001);
+        if (withVelocity) {
+            tr.vel.resize(1001);
+        }
+        for (int i = 0; i <= 1000; i++) {
+            double t = i / 100.0;
+            tr.pos[i] = Eigen::Vector3d(5 * cos(0.5 * t), 5 * sin(0.5 * t), 2 + 0.2 * t);
+            if (withVelocity) {
+                tr.vel[i] = Eigen::Vector3d(-2.5 * sin(0.5 * t), 2.5 * cos(0.5 * t), 0.2);
+            }
+        }
+        return tr;
+    }
+}
+
+TEST(SegmentedTrajectoryTestSuite, testFit) {
+    for (bool withVelocity : {true, false}) {
+        Trajectory tr = makeCircle(withVelocity);
+        SegmentedTrajectory segmented = SegmentedTrajectory::fit(tr, 100, 0.01);
+        ASSERT_NEAR(segmented.getDuration(), 10, 1e-9);
+        //far fewer segments than samples
+        ASSERT_LT(segmented.segments.size(), 50);
+        for (int i = 0; i <= 1000; i++) {
+            ASSERT_LE((segmented.evaluate(i / 100.0).pos - tr.pos[i]).norm(), 0.01 + 1e-9);
+        }
+    }
+    Trajectory tr = makeCircle(true);
+    SegmentedTrajectory segmented = SegmentedTrajectory::fit(tr, 100, 0.01);
+    ASSERT_LT((segmented.evaluate(5).vel - tr.vel[500]).norm(), 0.05);
+    //clamped to the trajectory
+    ASSERT_LT((segmented.evaluate(20).pos - tr.pos[1000]).norm(), 1e-9);
+}
+
+TEST(SegmentedTrajectoryTestSuite, testOffset) {
+    Trajectory tr = makeCircle(true);
+    Eigen::Vector3d home(1, -2, 0.5);
+    SegmentedTrajectory segmented = SegmentedTrajectory::fit(tr, 100, 0.01, -home);
+    ASSERT_LT((segmented.evaluate(0).pos - (tr.pos[0] - home)).norm(), 1e-9);
+    ASSERT_LT((segmented.evaluate(10).pos - (tr.pos[1000] - home)).norm(), 1e-9);
+}
+
+TEST(SegmentedTrajectoryTestSuite, testSingleSample) {
+    Trajectory tr;
+    tr.pos.push_back(Eigen::Vector3d(1, 2, 3));
+    SegmentedTrajectory segmented = SegmentedTrajectory::fit(tr, 100, 0.01);
+    ASSERT_EQ(segmented.segments.size(), 1);
+    ASSERT_LT((segmented.evaluate(1).pos - tr.pos[0]).norm(), 1e-9);
+}
+
+TEST(SegmentedTrajectoryTestSuite, testEncode) {
+    SegmentedTrajectory segmented = SegmentedTrajectory::fit(makeCircle(true), 100, 0.01);
+    segmented.trajectoryId = 7;
+    segmented.start = 1234.5;
+    vector<double> data;
+    segmented.encode(data);
+    ASSERT_EQ(data.size(), 3 + 13 * segmented.segments.size());
+
+    SegmentedTrajectory decoded;
+    ASSERT_TRUE(SegmentedTrajectory::decode(data, decoded));
+    ASSERT_EQ(decoded.trajectoryId, 7);
+    ASSERT_EQ(decoded.start, 1234.5);
+    ASSERT_EQ(decoded.segments.size(), segmented.segments.size());
+    for (double t = 0; t <= 10; t += 0.37) {
+        ASSERT_LT((decoded.evaluate(t).pos - segmented.evaluate(t).pos).norm(), 1e-12);
+    }
+
+    data.pop_back();
+    ASSERT_FALSE(SegmentedTrajectory::decode(data, decoded));
+    ASSERT_FALSE(SegmentedTrajectory::decode(vector<double>(2, 0), decoded));
+}
+
+/**
+ * stands in for the executor of a drone: two horizons are sent once, then sampled at the
+ * control rate and compared with the setpoints the central node would have published
+ */
+TEST(SegmentedTrajectoryTestSuite, testSchedule) {
+    Trajectory first = makeCircle(true);
+    Trajectory second;
+    second.pos.resize(501);
+    second.vel.resize(501);
+    for (int i = 0; i <= 500; i++) {
+        second.pos[i] = first.pos[1000] + Eigen::Vector3d(0, 0, 0.4 * i / 100.0);
+        second.vel[i] = Eigen::Vector3d(0, 0, 0.4);
+    }
+
+    SegmentSchedule schedule;
+    TrajectoryState state;
+    ASSERT_FALSE(schedule.sample(100, state));
+
+    SegmentedTrajectory a = SegmentedTrajectory::fit(first, 100, 0.01);
+    a.trajectoryId = 0;
+    a.start = 100;
+    SegmentedTrajectory b = SegmentedTrajectory::fit(second, 100, 0.01);
+    b.trajectoryId = 1;
+    b.start = 110;
+    vector<double> data;
+    SegmentedTrajectory received;
+    for (const SegmentedTrajectory &tr : {a, b}) {
+        tr.encode(data);
+        ASSERT_TRUE(SegmentedTrajectory::decode(data, received));
+        schedule.insert(received);
+    }
+
+    ASSERT_FALSE(schedule.sample(99.99, state));
+    for (int tick = 0; tick < 1500; tick++) {
+        double now = 100 + tick / 100.0 + 0.004;
+        ASSERT_TRUE(schedule.sample(now, state));
+        TrajectoryState expected = now < 110 ? first.interpolate(now - 100, 100) : second.interpolate(now - 110, 100);
+        ASSERT_LE((state.pos - expected.pos).norm(), 0.011);
+    }
+    //the first horizon was dropped once the second took over
+    ASSERT_EQ(schedule.size(), 1);
+
+    //a resent horizon replaces the one with the same id
+    b.start = 111;
+    schedule.insert(b);
+    ASSERT_TRUE(schedule.sample(111, state));
+    ASSERT_LT((state.pos - second.pos[0]).norm(), 1e-9);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
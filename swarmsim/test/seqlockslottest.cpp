@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "SeqlockSlot.h"
+
+using namespace std;
+
+struct Sample {
+    double values[8];
+};
+
+TEST(SeqlockSlotTestSuite, testLoadStore) {
+    SeqlockSlot<Sample> slot;
+    Sample s;
+    ASSERT_FALSE(slot.load(s));
+    for (int i = 0; i < 8; i++) {
+        s.values[i] = i;
+    }
+    slot.store(s);
+    Sample out;
+    ASSERT_TRUE(slot.load(out));
+    ASSERT_EQ(out.values[7], 7);
+}
+
+TEST(SeqlockSlotTestSuite, testConcurrentReaders) {
+    SeqlockSlot<Sample> slot;
+    atomic<bool> done(false);
+    atomic<int> torn(0);
+    vector<thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&]() {
+            double last = 0;
+            while (!done) {
+                Sample s;
+                if (!slot.load(s)) {
+                    continue;
+                }
+                //every store writes the same value to all fields and the values only grow
+                for (int i = 1; i < 8; i++) {
+                    if (s.values[i] != s.values[0]) {
+                        torn++;
+                    }
+                }
+                if (s.values[0] < last) {
+                    torn++;
+                }
+                last = s.values[0];
+            }
+        });
+    }
+    for (int k = 1; k <= 200000; k++) {
+        Sample s;
+        for (int i = 0; i < 8; i++) {
+            s.values[i] = k;
+        }
+        slot.store(s);
+    }
+    done = true;
+    for (thread &reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQ(torn, 0);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
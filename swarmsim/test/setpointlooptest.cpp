@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "SetpointLoop.h"
+
+using namespace std;
+
+TEST(SetpointLoopTestSuite, testRate) {
+    atomic<int> ticks(0);
+    //pinning and SCHED_FIFO may be refused without privileges, the loop runs either way
+    SetpointLoop loop(200, [&ticks]() { ticks++; }, 0, 10);
+    loop.start();
+    this_thread::sleep_for(chrono::milliseconds(500));
+    loop.stop();
+    ASSERT_GE(ticks, 80);
+    ASSERT_LE(ticks, 101);
+    LoopStats stats = loop.getStats();
+    ASSERT_EQ(stats.ticks, ticks);
+    ASSERT_EQ(loop.getStats().ticks, 0);
+}
+
+TEST(SetpointLoopTestSuite, testOverruns) {
+    atomic<int> ticks(0);
+    //every tick takes 2.5 periods, so the loop skips deadlines instead of bursting
+    SetpointLoop loop(100, [&ticks]() {
+        ticks++;
+        this_thread::sleep_for(chrono::milliseconds(25));
+    });
+    loop.start();
+    this_thread::sleep_for(chrono::milliseconds(300));
+    loop.stop();
+    LoopStats stats = loop.getStats();
+    ASSERT_LE(ticks, 12);
+    ASSERT_GE(stats.overruns, 2 * stats.ticks - 2);
+}
+
+TEST(SetpointLoopTestSuite, testInvalidRate) {
+    ASSERT_THROW(SetpointLoop(0, []() {}), runtime_error);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
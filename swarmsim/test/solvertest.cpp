@@ -10,7 +10,7 @@ using namespace Eigen;
 
 Trajectory getTestingTrajectory(Vector3d offset) {
     Trajectory tr; //only spline
-    vector<Vector3d> pos;
+    SampleSeries pos;
     Vector3d p1, p2, p3;
     p1 << 0,0,0;
     p2 << 3,3,3;
@@ -38,8 +38,8 @@ TEST(SwarmSimTestSuite, testSingleRobot) {
     Vector3d offset;
     offset << 0,0,0;
     wpts.push_back(getTestingTrajectory(offset));
-    vector<Trajectory> results = s.solve(wpts);
-    ASSERT_GT(results[0].pos.size(), 0); 
+    vector<TrajectoryPtr> results = s.solve(wpts, true, true, vector<TrajectoryPtr>());
+    ASSERT_GT(results[0]->pos.size(), 0); 
 }
 
 TEST(SwarmSimTestSuite, testMultiRobot) {
@@ -51,7 +51,7 @@ TEST(SwarmSimTestSuite, testMultiRobot) {
     wpts.push_back(getTestingTrajectory(offset));
     offset << 1,0,0;
     wpts.push_back(getTestingTrajectory(offset));
-    vector<Trajectory> results = s.solve(wpts);
+    vector<TrajectoryPtr> results = s.solve(wpts, true, true, vector<TrajectoryPtr>());
     ASSERT_EQ(results.size(), 2); 
 }
 
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Heartbeat.h"
+#include "StateCounters.h"
+
+using namespace std;
+
+TEST(StateCountersTestSuite, testTransitions) {
+    StateCounters counters;
+    for (int i = 0; i < 3; i++) {
+        counters.transition(-1, States::Idle);
+    }
+    ASSERT_EQ(counters.count(States::Idle), 3);
+    counters.transition(States::Idle, States::Ready);
+    counters.transition(States::Ready, States::Ready);
+    ASSERT_EQ(counters.count(States::Idle), 2);
+    ASSERT_EQ(counters.count(States::Ready), 1);
+    ASSERT_EQ(counters.getTransitions(), 4);
+    ASSERT_EQ(counters.count(-1), 0);
+    ASSERT_EQ(counters.count(NStates), 0);
+}
+
+/**
+ * drones moving through the states on their own threads, as they do from the callback,
+ * supervisory and setpoint threads, while the swarm reads the counters
+ */
+TEST(StateCountersTestSuite, testConcurrentTransitions) {
+    const int nDrones = 16;
+    StateCounters counters;
+    vector<atomic<int> > states(nDrones);
+    for (int i = 0; i < nDrones; i++) {
+        states[i] = States::Idle;
+        counters.transition(-1, States::Idle);
+    }
+    atomic<bool> done(false);
+    thread reader([&]() {
+        while (!done) {
+            int total = 0;
+            for (int s = 0; s < NStates; s++) {
+                total += counters.count(s);
+            }
+            //a drone may be seen in two states for a moment, never in none
+            ASSERT_GE(total, nDrones);
+        }
+    });
+    vector<thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.push_back(thread([&, t]() {
+            for (int round = 0; round < 2000; round++) {
+                for (int i = t; i < nDrones; i += 4) {
+                    int next = (states[i] + 1) % NStates;
+                    counters.transition(states[i].exchange(next), next);
+                }
+            }
+        }));
+    }
+    for (thread &writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+    //2000 rounds through 6 states bring every drone to state 2000 % 6
+    ASSERT_EQ(counters.count(2000 % NStates), nDrones);
+}
+
+/**
+ * the supervisory loop of the swarm at 20Hz for 10s, publishing the state on every change and
+ * on the heartbeat, as Swarm::iteration does
+ */
+TEST(StateCountersTestSuite, testStateHeartbeat) {
+    const double period = 1.0;
+    Heartbeat heartbeat(period);
+    double lastPublish = -1;
+    int heartbeats = 0;
+    for (int tick = 0; tick < 200; tick++) {
+        //a sim clock, far from the wall clock
+        double now = 1000 + tick / 20.0;
+        if (tick == 10 || tick == 75 || tick == 76) {
+            //state changes
+            heartbeat.sent(now);
+            lastPublish = now;
+        }
+        if (heartbeat.due(now)) {
+            if (lastPublish >= 0) {
+                ASSERT_GE(now - lastPublish, period - 1e-9);
+            }
+            heartbeat.sent(now);
+            lastPublish = now;
+            heartbeats++;
+        }
+    }
+    //once at the first tick, then never more often than once a period
+    ASSERT_LE(heartbeats, 10);
+    ASSERT_GE(heartbeats, 8);
+
+    Heartbeat disabled(0);
+    ASSERT_FALSE(disabled.due(1e9));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
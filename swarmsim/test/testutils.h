@@ -0,0 +1,35 @@
+#ifndef SWARMSIM_TEST_UTILS_H
+#define SWARMSIM_TEST_UTILS_H
+
+#include <memory>
+#include "Trajectory.h"
+
+/**
+ * trajectory fixtures shared by the tests
+ */
+namespace testutils {
+    enum Derivatives {PositionOnly, WithVelocity, WithVelocityAndAcceleration};
+
+    /**
+     * nSamples along a straight line, sample i at start + i * step. Each sample gets the velocity vel
+     * and the acceleration acc, as far as derivatives keeps them.
+     */
+    inline std::shared_ptr<Trajectory> getLine(const Eigen::Vector3d &start, const Eigen::Vector3d &step,
+                                               int nSamples, Derivatives derivatives = WithVelocityAndAcceleration,
+                                               const Eigen::Vector3d &vel = Eigen::Vector3d::Zero(),
+                                               const Eigen::Vector3d &acc = Eigen::Vector3d::Zero()) {
+        auto tr = std::make_shared<Trajectory>();
+        for (int i = 0; i < nSamples; i++) {
+            tr->pos.push_back(start + i * step);
+            if (derivatives != PositionOnly) {
+                tr->vel.push_back(vel);
+            }
+            if (derivatives == WithVelocityAndAcceleration) {
+                tr->acc.push_back(acc);
+            }
+        }
+        return tr;
+    }
+}
+
+#endif
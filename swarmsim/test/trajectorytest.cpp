@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include "Trajectory.h"
+#include "MemoryAccounting.h"
+
+using namespace std;
+using namespace Eigen;
+
+TEST(TrajectoryTestSuite, testSampleSeries) {
+    SampleSeries s;
+    for (int i = 0; i < 100; i++) {
+        s.push_back(Vector3d(i, 2 * i, 3 * i));
+    }
+    ASSERT_EQ(s.size(), 100);
+    ASSERT_EQ(s[42], Vector3d(42, 84, 126));
+    ASSERT_EQ(s.back(), Vector3d(99, 198, 297));
+    //each component is a contiguous, aligned series
+    ASSERT_EQ(s.data(1)[42], 84);
+    ASSERT_EQ((uintptr_t) s.data(2) % 64, 0);
+
+    s[42] = Vector3d(-1, -2, -3);
+    ASSERT_EQ(s.data(0)[42], -1);
+    ASSERT_EQ(s.data(2)[42], -3);
+
+    SampleSeries tail;
+    tail.push_back(Vector3d::Zero());
+    tail.append(s, 98, 100);
+    ASSERT_EQ(tail.size(), 3);
+    ASSERT_EQ(tail[1], s[98]);
+
+    SampleSeries copy = s;
+    ASSERT_EQ(copy, s);
+    copy[0] = Vector3d::Ones();
+    ASSERT_NE(copy, s);
+}
+
+TEST(TrajectoryTestSuite, testArenaTrajectories) {
+    auto arena = make_shared<TrajectoryArena>();
+    vector<TrajectoryPtr> plan;
+    for (int k = 0; k < 20; k++) {
+        auto tr = make_shared<Trajectory>();
+        tr->allocate(301, arena);
+        for (int i = 0; i < 301; i++) {
+            tr->pos[i] = Vector3d(k, i, 2.5);
+            tr->vel[i] = Vector3d(0, 1, 0);
+            tr->acc[i] = Vector3d::Zero();
+        }
+        plan.push_back(tr);
+    }
+    //the 9 series of all 20 trajectories come out of a single block
+    ASSERT_EQ(arena->getReserved(), 1 << 20);
+    TrajectoryState s = plan[7]->getState(300);
+    ASSERT_EQ(s.pos, Vector3d(7, 300, 2.5));
+    ASSERT_EQ(s.vel, Vector3d(0, 1, 0));
+
+    //copies own their samples and outlive the arena
+    Trajectory copy = *plan[7];
+    arena.reset();
+    plan.clear();
+    ASSERT_FALSE(copy.arena);
+    ASSERT_EQ(copy.pos[300], Vector3d(7, 300, 2.5));
+}
+
+TEST(TrajectoryTestSuite, testAssignArenaTrajectories) {
+    Trajectory a;
+    a.allocate(400);
+    Trajectory b;
+    b.allocate(300, make_shared<TrajectoryArena>());
+    for (int i = 0; i < 300; i++) {
+        b.pos[i] = Vector3d(i, 1, 2);
+        b.vel[i] = Vector3d(0, i, 0);
+        b.acc[i] = Vector3d::Zero();
+    }
+    //the arena of a is dropped while its samples are replaced, they must not be written into it
+    a = b;
+    b.arena.reset();
+    b = Trajectory();
+    ASSERT_FALSE(a.arena);
+    ASSERT_EQ(a.pos.size(), 300);
+    ASSERT_EQ(a.pos[299], Vector3d(299, 1, 2));
+    ASSERT_EQ(a.vel[42], Vector3d(0, 42, 0));
+}
+
+TEST(TrajectoryTestSuite, testInterpolate) {
+    //a cubic is reproduced exactly from its samples and their derivatives
+    const double rate = 10;
+    Trajectory tr;
+    tr.allocate(11);
+    for (int i = 0; i <= 10; i++) {
+        double t = i / rate;
+        tr.pos[i] = Vector3d(t * t * t, 2 * t, 1);
+        tr.vel[i] = Vector3d(3 * t * t, 2, 0);
+        tr.acc[i] = Vector3d(6 * t, 0, 0);
+    }
+    TrajectoryState s = tr.interpolate(0.437, rate);
+    ASSERT_NEAR(s.pos[0], 0.437 * 0.437 * 0.437, 1e-12);
+    ASSERT_NEAR(s.pos[1], 0.874, 1e-12);
+    ASSERT_NEAR(s.acc[0], 6 * 0.437, 1e-12);
+    ASSERT_EQ(tr.interpolate(0.3, rate).pos, tr.pos[3]);
+
+    //clamped to the ends
+    ASSERT_EQ(tr.interpolate(-1, rate).pos, tr.pos[0]);
+    ASSERT_EQ(tr.interpolate(5, rate).pos, tr.pos[10]);
+
+    //position files have no derivatives, their samples are joined linearly
+    Trajectory wpts;
+    wpts.pos.push_back(Vector3d(0, 0, 0));
+    wpts.pos.push_back(Vector3d(1, 2, 3));
+    ASSERT_TRUE(wpts.interpolate(0.025, rate).pos.isApprox(Vector3d(0.25, 0.5, 0.75)));
+}
+
+TEST(TrajectoryTestSuite, testMemoryAccounting) {
+    size_t baseline = MemoryAccounting::getLiveBytes(TrajectoryMemory);
+    {
+        auto arena = make_shared<TrajectoryArena>();
+        vector<TrajectoryPtr> plan;
+        for (int k = 0; k < 4; k++) {
+            auto tr = make_shared<Trajectory>();
+            tr->allocate(301, arena);
+            plan.push_back(tr);
+        }
+        SampleSeries s;
+        s.resize(100);
+        ASSERT_EQ(MemoryAccounting::getLiveBytes(TrajectoryMemory), baseline + (1 << 20) + 3 * 104 * sizeof(double));
+        arena.reset();
+        //the arena lives until its last trajectory is retired
+        ASSERT_GT(MemoryAccounting::getLiveBytes(TrajectoryMemory), baseline + (1 << 20));
+    }
+    ASSERT_EQ(MemoryAccounting::getLiveBytes(TrajectoryMemory), baseline);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,107 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include "FlightRecorder.h"
+
+using namespace std;
+
+namespace {
+    const char *EVENT_NAMES[] = {"planning started", "planning committed", "planning failed", "splice started",
+                                 "splice adopted"};
+
+    struct DroneStats {
+        int setpoints = 0;
+        int poses = 0;
+        int trackedPoses = 0;
+        double errorSum = 0;
+        double maxError = 0;
+        bool hasSetpoint = false;
+        Eigen::Vector3d lastSetpoint;
+    };
+}
+
+/**
+ * Reads a flight log written by FlightRecorder.
+ * usage: swarmsim_flight_replay flight.log [--csv]
+ * Without --csv it prints the swarm state changes, the planning events and the tracking
+ * error of every drone, measured from each pose to the last setpoint sent before it.
+ */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " flight.log [--csv]" << endl;
+        return 1;
+    }
+    vector<FlightRecord> records;
+    try {
+        records = FlightRecorder::readLog(argv[1]);
+    }
+    catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    if (argc > 2 && strcmp(argv[2], "--csv") == 0) {
+        cout << "stamp,type,event,drone,value,x,y,z" << endl;
+        cout << setprecision(12);
+        for (const FlightRecord &r : records) {
+            cout << r.stamp << "," << (int) r.type << "," << (int) r.event << "," << r.droneId << "," << r.value
+                 << "," << r.x << "," << r.y << "," << r.z << endl;
+        }
+        return 0;
+    }
+
+    if (records.empty()) {
+        cout << "The log is empty" << endl;
+        return 0;
+    }
+    double t0 = records[0].stamp;
+    int lastState = -1;
+    map<int, DroneStats> drones;
+    cout << fixed << setprecision(3);
+    for (const FlightRecord &r : records) {
+        switch (r.type) {
+            case SwarmStateRecord:
+                if (r.value != lastState) {
+                    cout << r.stamp - t0 << "s swarm state " << r.value << endl;
+                    lastState = r.value;
+                }
+                break;
+            case PlanningRecord:
+                cout << r.stamp - t0 << "s " << (r.event < 5 ? EVENT_NAMES[r.event] : "unknown event")
+                     << " horizon " << r.value << endl;
+                break;
+            case SetpointRecord: {
+                DroneStats &d = drones[r.droneId];
+                d.setpoints++;
+                d.lastSetpoint = Eigen::Vector3d(r.x, r.y, r.z);
+                d.hasSetpoint = true;
+                break;
+            }
+            case PoseRecord: {
+                DroneStats &d = drones[r.droneId];
+                d.poses++;
+                if (d.hasSetpoint) {
+                    double error = (Eigen::Vector3d(r.x, r.y, r.z) - d.lastSetpoint).norm();
+                    d.errorSum += error;
+                    d.maxError = max(d.maxError, error);
+                    d.trackedPoses++;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    cout << records.size() << " records over " << records.back().stamp - t0 << "s" << endl;
+    for (auto &entry : drones) {
+        const DroneStats &d = entry.second;
+        cout << "drone " << entry.first << ": " << d.setpoints << " setpoints, " << d.poses << " poses";
+        if (d.trackedPoses > 0) {
+            cout << ", tracking error mean " << d.errorSum / d.trackedPoses << "m max " << d.maxError << "m";
+        }
+        cout << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "MissionParser.h"
+#include "CompiledMission.h"
+#include "solver.h"
+#include "utils.h"
+
+using namespace std;
+
+/**
+ * Solves every horizon of a mission offline and writes them to a compiled mission that
+ * Swarm can map and fly without planning.
+ * usage: swarmsim_mission_compiler mission.yaml obstacles.yaml|- out.bin [frequency] [maxVel] [maxAcc] [jobs]
+ */
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cerr << "usage: " << argv[0] << " mission.yaml obstacles.yaml|- out.bin [frequency] [maxVel] [maxAcc] [jobs]"
+             << endl;
+        return 1;
+    }
+    string missionPath = argv[1];
+    string obstaclePath = argv[2];
+    string outPath = argv[3];
+    double frequency = argc > 4 ? atof(argv[4]) : 100;
+    double maxVel = argc > 5 ? atof(argv[5]) : 4;
+    double maxAcc = argc > 6 ? atof(argv[6]) : 4;
+    int nJobs = argc > 7 ? atoi(argv[7]) : max<int>(thread::hardware_concurrency(), 1);
+
+    auto start = chrono::steady_clock::now();
+    YamlDescriptor yamlDescriptor;
+    vector<Obstacle> obstacles;
+    try {
+        MissionParser::parseFile(missionPath, yamlDescriptor);
+        if (obstaclePath != "-") {
+            obstacles = simutils::readObstacleConfig(obstaclePath);
+        }
+    }
+    catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    int nDrones = yamlDescriptor.getDrones();
+    int nHorizons = yamlDescriptor.getHorizons();
+
+    //the start of a horizon only depends on the last subgoal of the previous one,
+    //so every horizon can be solved independently
+    vector<vector<TrajectoryPtr> > plans(nHorizons);
+    atomic<int> nextHorizon(0);
+    atomic<bool> failed(false);
+    auto solveHorizons = [&]() {
+        for (int h = nextHorizon++; h < nHorizons && !failed; h = nextHorizon++) {
+            try {
+                vector<Trajectory> wpts = simutils::getHorizonTrajetories(h, yamlDescriptor);
+                vector<TrajectoryPtr> seeds;
+                if (h > 0) {
+                    for (const Trajectory &prev : simutils::getHorizonTrajetories(h - 1, yamlDescriptor)) {
+                        Trajectory seed;
+                        seed.pos.push_back(prev.pos[prev.pos.size() - 1]);
+                        seed.vel.push_back(Eigen::Vector3d::Zero());
+                        seed.acc.push_back(Eigen::Vector3d::Zero());
+                        seeds.push_back(make_shared<const Trajectory>(move(seed)));
+                    }
+                }
+                Solver solver(nDrones, maxVel, maxAcc, frequency);
+                //same boundary conditions as PlanningPhase::isInitialHorizon and isLastHorizon
+                plans[h] = solver.solve(wpts, h == 0, h == nHorizons, seeds);
+                cout << "Solved horizon " << h << endl;
+            }
+            catch (exception &e) {
+                cerr << "Failed to solve horizon " << h << ": " << e.what() << endl;
+                failed = true;
+            }
+        }
+    };
+    vector<thread> workers;
+    for (int j = 1; j < min(nJobs, nHorizons); j++) {
+        workers.push_back(thread(solveHorizons));
+    }
+    solveHorizons();
+    for (thread &worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return 1;
+    }
+
+    try {
+        CompiledMission::write(outPath, frequency, plans, obstacles);
+    }
+    catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Compiled " << nDrones << " drones, " << nHorizons << " horizons and " << obstacles.size()
+         << " obstacles into " << outPath << " in " << secs << " s" << endl;
+    return 0;
+}
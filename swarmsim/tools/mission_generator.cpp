@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include "MissionGenerator.h"
+
+using namespace std;
+
+/**
+ * Writes goals.yaml, obstacles.yaml and pos_<i>.txt for a synthetic mission into dir.
+ * usage: swarmsim_mission_generator dir [drones] [horizons] [subgoals] [obstacles] [seed]
+ */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " dir [drones] [horizons] [subgoals] [obstacles] [seed]" << endl;
+        return 1;
+    }
+    string dir = argv[1];
+    if (dir[dir.size() - 1] != '/') {
+        dir += "/";
+    }
+    MissionSpec spec;
+    if (argc > 2) spec.nDrones = atoi(argv[2]);
+    if (argc > 3) spec.nHorizons = atoi(argv[3]);
+    if (argc > 4) spec.nSubgoals = atoi(argv[4]);
+    if (argc > 5) spec.nObstacles = atoi(argv[5]);
+    if (argc > 6) spec.seed = strtoul(argv[6], NULL, 10);
+    if (spec.nDrones < 1 || spec.nHorizons < 1 || spec.nSubgoals < 2 || spec.nObstacles < 0) {
+        cerr << "A mission needs at least one drone, one horizon and two subgoals" << endl;
+        return 1;
+    }
+
+    mkdir(dir.c_str(), 0755);
+    try {
+        MissionGenerator generator(spec);
+        generator.writeMission(dir + "goals.yaml");
+        generator.writeObstacles(dir + "obstacles.yaml");
+        generator.writeTrajectories(dir);
+    }
+    catch (runtime_error &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    cout << "Generated " << spec.nDrones << " drones, " << spec.nHorizons << " horizons, " << spec.nSubgoals
+         << " subgoals and " << spec.nObstacles << " obstacles in " << dir << " (seed " << spec.seed << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "ros/ros.h"
+#include "SegmentExecutor.h"
+#include "SetpointLoop.h"
+
+/**
+ * Executes the segmented horizons of one drone when the swarm runs with segmentExecution.
+ * usage: rosrun swarmsim swarmsim_segment_executor _droneId:=0 [_rate:=100] [_feedforward:=false]
+ */
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "segment_executor", ros::init_options::AnonymousName);
+    ros::NodeHandle nh;
+    ros::NodeHandle pnh("~");
+    int droneId, cpu, priority;
+    double rate;
+    bool feedforward;
+    pnh.param("droneId", droneId, 0);
+    pnh.param("rate", rate, 100.0);
+    pnh.param("feedforward", feedforward, false);
+    pnh.param("cpu", cpu, -1);
+    pnh.param("priority", priority, 0);
+
+    SegmentExecutor executor(droneId, nh, feedforward);
+    SetpointLoop loop(rate, [&executor]() {
+        executor.tick(ros::Time::now().toSec());
+    }, cpu, priority);
+    loop.start();
+    ros::spin();
+    loop.stop();
+    return 0;
+}
@@ -13,37 +13,12 @@ int main(int argc, char **argv) {
     float frequency = 100;
     ros::init(argc, argv, "swarmsim_example");
     static ros::NodeHandle n("~");
-    int nDrones;
-    bool predefinedTrajectories;
-    string yamlFileName;
-    string trajDir;
-    bool visualizeTraj;
-    string obstacleConfigFileName;
-
-    n.param("/swarmsim_example/nDrones", nDrones, 1);
-    n.param("/swarmsim_example/predefined", predefinedTrajectories, false);
-    n.getParam("/swarmsim_example/trajDir", trajDir);
-    n.getParam("/swarmsim_example/yamlFileName", yamlFileName);
-    n.getParam("/swarmsim_example/visualize", visualizeTraj);
-    n.getParam("/swarmsim_example/obstacleFileName", obstacleConfigFileName);
-
-    ROS_DEBUG_STREAM("Number of drones: " << nDrones);
-    ROS_DEBUG_STREAM("Visualize trajectories: "<< visualizeTraj);
-    ROS_DEBUG_STREAM("Use predefined trajectories: " << predefinedTrajectories);
-    ROS_DEBUG_STREAM("Trajectory dir: " << trajDir);
-    ROS_DEBUG_STREAM("obstacleConfigFileName: " << obstacleConfigFileName);
-
-    Swarm* sim;
-
-    if(!predefinedTrajectories) {
-        ROS_DEBUG_STREAM("YAML file name: " << yamlFileName);
-        sim = new Swarm(n, frequency, nDrones, trajDir, yamlFileName, 
-            visualizeTraj, obstacleConfigFileName);
-    }
-    else {
-        sim = new Swarm(n, frequency, nDrones, trajDir, visualizeTraj, 
-            obstacleConfigFileName);
+    Swarm *sim = Swarm::create(n, frequency);
+    if (sim == nullptr) {
+        return 1;
     }
     sim->run(frequency);
+    //closes the flight log
+    delete sim;
     return 0;
 }
\ No newline at end of file
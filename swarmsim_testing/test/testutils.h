@@ -79,7 +79,7 @@ class TestUtils : public testing::Test {
         bool assertPosition(int horzid, int posId, int droneId) {
             DroneTrajectory drone_tr = yamlDescriptor.getdroneTrajectories()[droneId];
 
-            vector<Eigen::Vector3d> targetPosList = drone_tr.horzTrajList[horzid].pos;
+            const SampleSeries &targetPosList = drone_tr.horzTrajList[horzid].pos;
             Eigen::Vector3d targetPos = targetPosList[posId];
             geometry_msgs::Pose robot_pose = pose_vec[gazeboPoseIdList[droneId]];
             Eigen::Vector3d currPos;